@@ -1,6 +1,7 @@
 #pragma once
 #ifndef CMC_EXT_OSCILLATOR_H
 #define CMC_EXT_OSCILLATOR_H
+#include <math.h>
 #include <stdint.h>
 #ifdef __cplusplus
 
@@ -59,6 +60,8 @@ class ExtendedOscillator {
     waveform_ = WAVE_SIN;
     eoc_ = true;
     eor_ = true;
+    last_out_ = 0.0f;
+    last_freq_ = freq_;
   }
 
   /** Gets the current frequency of the oscillator.
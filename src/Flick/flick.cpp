@@ -23,19 +23,25 @@
 #include "daisysp.h"
 #include "extended_oscillator.h"
 #include "hothouse.h"
+#include "memory_plan.h"
+#include "stereo_delay.h"
 #include "Dattorro.hpp"
+#include "DattorroBypass.hpp"
+#include "DattorroParameters.hpp"
+#include <atomic>
 #include <math.h>
 
 using clevelandmusicco::ExtendedOscillator;
 using clevelandmusicco::Hothouse;
+using clevelandmusicco::MemoryNeed;
+using clevelandmusicco::MemoryPlan;
+using clevelandmusicco::StereoDelay;
 using daisy::AudioHandle;
 using daisy::Led;
 using daisy::Parameter;
 using daisy::PersistentStorage;
 using daisy::SaiHandle;
 using daisy::System;
-using daisysp::DelayLine;
-using daisysp::fonepole;
 
 /// Increment this when changing the settings struct so the software will know
 /// to reset to defaults if this ever changes.
@@ -85,10 +91,23 @@ PersistentStorage<Settings> SavedSettings(hw.seed.qspi);
 ExtendedOscillator osc;
 float dc_os = 0;
 
-DelayLine<float, MAX_DELAY> DSY_SDRAM_BSS delMemL;
-DelayLine<float, MAX_DELAY> DSY_SDRAM_BSS delMemR;
+// Everything in SDRAM outside the plate's delay arena comes from one pool,
+// laid out at compile time. The delay's two lines run whenever the pedal
+// does. Build with -DMEMORY_REPORT to have the layout printed at boot.
+typedef StereoDelay<MAX_DELAY> FlickDelay;
+enum FlickMemory { MEMORY_DELAY, FLICK_MEMORY_LAST };
+constexpr MemoryNeed kMemoryNeeds[FLICK_MEMORY_LAST] = {
+  {"delay", clevelandmusicco::MEMORY_SDRAM, sizeof(FlickDelay), clevelandmusicco::kAlwaysActive},
+};
+constexpr MemoryPlan<FLICK_MEMORY_LAST> kMemoryPlan(kMemoryNeeds);
+static_assert(kMemoryPlan.Fits(), "Flick's memory plan doesn't fit");
+alignas(MemoryPlan<FLICK_MEMORY_LAST>::kAlignment) uint8_t DSY_SDRAM_BSS
+    sdramPool[kMemoryPlan.Footprint(clevelandmusicco::MEMORY_SDRAM)];
 
 Dattorro verb(48000, 16, 4.0);
+// Every change to the plate goes through here so that it only recomputes what
+// has moved.
+DattorroParameters verbParams(verb);
 ReverbMode verb_mode = REVERB_MODE_NORMAL;
 
 Parameter p_verb_amt;
@@ -97,24 +116,6 @@ Parameter p_delay_time, p_delay_feedback, p_delay_amt;
 
 Parameter p_knob_1, p_knob_2, p_knob_3, p_knob_4, p_knob_5, p_knob_6;
 
-struct Delay {
-  DelayLine<float, MAX_DELAY> *del;
-  float currentDelay;
-  float delayTarget;
-  float feedback;
-
-  float Process(float in) {
-    // set delay times
-    fonepole(currentDelay, delayTarget, 0.0002f);
-    del->SetDelay(currentDelay);
-
-    float read = del->Read();
-    del->Write((feedback * read) + in);
-
-    return read;
-  }
-};
-
 enum ReverbKnobMode {
   REVERB_KNOB_ALL_DRY,
   REVERB_KNOB_DRY_WET_MIX,
@@ -145,8 +146,9 @@ constexpr int kWaveformMap[] = {
     ExtendedOscillator::WAVE_SIN,             // DOWN
 };
 
-Delay delayL;
-Delay delayR;
+// Both channels share the delay time and the feedback, and the delay runs a
+// block at a time (see StereoDelay).
+FlickDelay *delay;
 int delay_drywet;
 
 float reverb_tone;
@@ -196,6 +198,24 @@ float plateTankModSpeed = 1.0;
 float plateTankModDepth = 0.5;
 float plateTankModShape = 0.75;
 
+// Most samples the plate is handed at once. Blocks bigger than this are
+// split up.
+const size_t kVerbChunk = 32;
+
+// With the delay and the tremolo running as well, the plate drops to this
+// tier so that all three fit in the callback with room to spare (see
+// Dattorro::setQuality()). Otherwise it runs at QUALITY_HIGH. The tank's
+// delays are whole samples here already, so QUALITY_MEDIUM saves little.
+const ReverbQuality kVerbQualityWithAllEffects = QUALITY_LOW;
+
+// Fades the plate in and out. Turning it off also clears it, a piece per
+// callback, so that it comes back without the old tail.
+DattorroBypass verbBypass(verb);
+const bool kKillVerbTailOnBypass = true;
+
+// Set once main() has zeroed the delay lines and the plate's memory.
+std::atomic<bool> delay_memory_cleared(false);
+
 const float minus18dBGain = 0.12589254;
 const float minus20dBGain = 0.1;
 
@@ -226,6 +246,19 @@ bool is_factory_reset_mode = false;
 /// 3: User must rotate knob_1 to 0% to complete the factory reset.
 int factory_reset_stage = 0;
 
+/// @brief Hands the current plate settings to verbParams. They reach the
+/// reverb on the next verbParams.apply().
+void set_verb_params() {
+  verbParams.set(DattorroParameters::DECAY, plateDecay);
+  verbParams.set(DattorroParameters::TANK_DIFFUSION, plateTankDiffusion);
+  verbParams.set(DattorroParameters::INPUT_HIGH_CUT_PITCH, plateInputDampHigh);
+  verbParams.set(DattorroParameters::TANK_HIGH_CUT_PITCH, plateTankDampHigh);
+  verbParams.set(DattorroParameters::TANK_MOD_SPEED, plateTankModSpeed);
+  verbParams.set(DattorroParameters::TANK_MOD_DEPTH, plateTankModDepth);
+  verbParams.set(DattorroParameters::TANK_MOD_SHAPE, plateTankModShape);
+  verbParams.set(DattorroParameters::PRE_DELAY, platePreDelay);
+}
+
 void load_settings() {
 
 	// Reference to local copy of settings stored in flash
@@ -249,14 +282,8 @@ void load_settings() {
   plateTankModShape = LocalSettings.tankModShape;
   platePreDelay = LocalSettings.preDelay;
 
-  verb.setPreDelay(platePreDelay);
-  verb.setInputFilterHighCutoffPitch(plateInputDampHigh);
-  verb.setDecay(plateDecay);
-  verb.setTankDiffusion(plateTankDiffusion);
-  verb.setTankFilterHighCutFrequency(plateTankDampHigh);
-  verb.setTankModSpeed(plateTankModSpeed);
-  verb.setTankModDepth(plateTankModDepth);
-  verb.setTankModShape(plateTankModShape);
+  set_verb_params();
+  verbParams.apply();
 }
 
 void save_settings() {
@@ -350,6 +377,10 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
     // Normal mode
     led_left.Set(bypass_verb ? 0.0f : 1.0f);
 
+#ifdef LOAD_METER_LED
+    // Debug build: the right LED shows how busy this callback is
+    hw.ShowLoadOnLed(led_right);
+#else
     // Reduce number of LED Updates for pulsing trem LED
     {
       static int count = 0;
@@ -362,6 +393,7 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
         led_right.Set(bypass_trem ? bypass_delay ? 0.0f : 1.0 : bypass_delay ? trem_val * 0.4 : trem_val);
       }
     }
+#endif
   }
   led_left.Update();
   led_right.Update();
@@ -383,8 +415,8 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
     //
     // Delay
     //
-    delayL.delayTarget = delayR.delayTarget =  p_delay_time.Process();
-    delayL.feedback = delayR.feedback = p_delay_feedback.Process();
+    delay->SetDelay(p_delay_time.Process());
+    delay->SetFeedback(p_delay_feedback.Process());
     delay_drywet = (int)p_delay_amt.Process();
 
     // Reverb dry/wet mode
@@ -424,41 +456,38 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
     static const float tank_mod_shape_values[] = {1.0f, 0.5f, 0.1f};
     plateTankModShape = tank_mod_shape_values[hw.GetToggleswitchPosition(Hothouse::TOGGLESWITCH_3)];
 
-    verb.setDecay(plateDecay);
-    verb.setTankDiffusion(plateTankDiffusion);
-    verb.setInputFilterHighCutoffPitch(plateInputDampHigh);
-    verb.setTankFilterHighCutFrequency(plateTankDampHigh);
+    // Only the parameters that moved are recomputed
+    set_verb_params();
+    verbParams.apply();
+  }
+
+  // Until their memory has been cleared the delay and the plate sit out, as
+  // if they were bypassed, and then the plate fades in.
+  const bool memory_ready = delay_memory_cleared;
 
-    verb.setTankModSpeed(plateTankModSpeed);
-    verb.setTankModDepth(plateTankModDepth);
-    verb.setTankModShape(plateTankModShape);
-    verb.setPreDelay(platePreDelay);    
+  // The delay runs over the whole block, into the output buffers, and the
+  // tremolo then goes over them a sample at a time.
+  if (!bypass_delay && memory_ready) {
+    delay->Process(in[0], in[1], out[0], out[1], size);
+
+    float fdrywet = delay_drywet / 100.0f;
+    float delay_make_up_gain = makeup_gain == TV_MAKEUP_GAIN_NONE ? 1.0f : makeup_gain == TV_MAKEUP_GAIN_NORMAL ? 1.66f : 2.0f;
+
+    // apply drywet and attenuate
+    for (size_t i = 0; i < size; ++i) {
+      out[0][i] = fdrywet * out[0][i] * 0.333f + (1.0f - fdrywet) * in[0][i] * delay_make_up_gain;
+      out[1][i] = fdrywet * out[1][i] * 0.333f + (1.0f - fdrywet) * in[1][i] * delay_make_up_gain;
+    }
+  } else {
+    for (size_t i = 0; i < size; ++i) {
+      out[0][i] = in[0][i];
+      out[1][i] = in[1][i];
+    }
   }
 
   for (size_t i = 0; i < size; ++i) {
-    float dry_L = in[0][i];
-    float dry_R = in[1][i];
-    float s_L, s_R;
-    s_L = dry_L;
-    s_R = dry_R;
-
-    if (!bypass_delay) {
-      float mixL = 0;
-      float mixR = 0;
-      float fdrywet = delay_drywet / 100.0f;
-
-      // update delayline with feedback
-      float sigL = delayL.Process(s_L);
-      float sigR = delayR.Process(s_R);
-      mixL += sigL;
-      mixR += sigR;
-
-      float delay_make_up_gain = makeup_gain == TV_MAKEUP_GAIN_NONE ? 1.0f : makeup_gain == TV_MAKEUP_GAIN_NORMAL ? 1.66f : 2.0f;
-
-      // apply drywet and attenuate
-      s_L = fdrywet * mixL * 0.333f + (1.0f - fdrywet) * s_L * delay_make_up_gain;
-      s_R = fdrywet * mixR * 0.333f + (1.0f - fdrywet) * s_R * delay_make_up_gain;
-    }
+    float s_L = out[0][i];
+    float s_R = out[1][i];
 
     if (!bypass_trem) {
       // trem_val gets used above for pulsing LED
@@ -468,23 +497,39 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
       s_L = s_L * trem_val * trem_make_up_gain;
       s_R = s_R * trem_val * trem_make_up_gain;
     }
-    if (!bypass_verb) {
-      // Dattorro seems to want to have values between -10 and 10 so times by 10
-      leftInput = hardLimit100_(s_L) * 10.0f;
-      rightInput = hardLimit100_(s_R) * 10.0f;
 
-      verb.process(leftInput * minus18dBGain * minus20dBGain * (1.0f + inputAmplification * 7.0f) * clearPopCancelValue,
-                    rightInput * minus18dBGain * minus20dBGain * (1.0f + inputAmplification * 7.0f) * clearPopCancelValue);
+    out[0][i] = s_L;
+    out[1][i] = s_R;
+  }
 
-      leftOutput = ((leftInput * plateDry * 0.1) + (verb.getLeftOutput() * plateWet * clearPopCancelValue));
-      rightOutput = ((rightInput * plateDry * 0.1) + (verb.getRightOutput() * plateWet * clearPopCancelValue));
+  verb.setQuality(!bypass_delay && !bypass_trem ? kVerbQualityWithAllEffects : QUALITY_HIGH);
+  if (verbBypass.update(!bypass_verb && memory_ready, size)) {
+    const float inputGain = minus18dBGain * minus20dBGain * (1.0f + inputAmplification * 7.0f);
+
+    // The plate runs a chunk at a time, in place in these buffers
+    float verbLeft[kVerbChunk];
+    float verbRight[kVerbChunk];
+    for (size_t start = 0; start < size; start += kVerbChunk) {
+      const size_t n = size - start < kVerbChunk ? size - start : kVerbChunk;
+      for (size_t i = 0; i < n; ++i) {
+        // Dattorro seems to want to have values between -10 and 10 so times by 10
+        verbLeft[i] = hardLimit100_(out[0][start + i]) * 10.0f * inputGain;
+        verbRight[i] = hardLimit100_(out[1][start + i]) * 10.0f * inputGain;
+      }
 
-      s_L = leftOutput;
-      s_R = rightOutput;
-    }
+      verb.process(verbLeft, verbRight, verbLeft, verbRight, n);
 
-    out[0][i] = s_L;
-    out[1][i] = s_R;
+      for (size_t i = 0; i < n; ++i) {
+        leftInput = hardLimit100_(out[0][start + i]) * 10.0f;
+        rightInput = hardLimit100_(out[1][start + i]) * 10.0f;
+
+        leftOutput = ((leftInput * plateDry * 0.1) + (verbLeft[i] * plateWet));
+        rightOutput = ((rightInput * plateDry * 0.1) + (verbRight[i] * plateWet));
+
+        out[0][start + i] = leftOutput;
+        out[1][start + i] = rightOutput;
+      }
+    }
   }
 }
 
@@ -518,29 +563,27 @@ int main() {
   p_delay_feedback.Init(hw.knobs[Hothouse::KNOB_5], 0.0f, 1.0f, Parameter::LINEAR);
   p_delay_amt.Init(hw.knobs[Hothouse::KNOB_6], 0.0f, 100.0f, Parameter::LINEAR);
 
-  delMemL.Init();
-  delMemR.Init();
-  delayL.del = &delMemL;
-  delayR.del = &delMemR;
+  delay = kMemoryPlan.Construct<FlickDelay>(sdramPool, MEMORY_DELAY);
+#ifdef MEMORY_REPORT
+  hw.seed.StartLog();
+  kMemoryPlan.Report([](const char* line) { hw.seed.PrintLine("%s", line); });
+#endif
 
   osc.Init(hw.AudioSampleRate());
 
   //
   // Dattorro Reverb Initialization
   //
-  // Zero out the InterpDelay buffers used by the plate reverb
-  for(int i = 0; i < 50; i++) {
-      for(int j = 0; j < 144000; j++) {
-          sdramData[i][j] = 0.;
-      }
-  }
-  // Set this to 1.0 or plate reverb won't work. This is defined in Dattorro's
-  // InterpDelay.cpp file.
-  hold = 1.;
-
+  // Move the plate's busiest delays into on-chip memory. Their memory is
+  // zeroed once the audio is running.
+  delayPlacement.place();
   verb.setSampleRate(48000);
   verb.setTimeScale(plateTimeScale);
+  // The time scale is fixed, so the tank's delays can be rounded to whole
+  // samples. Without modulation the plate then runs without interpolating.
+  verb.setWholeSampleDelays(true);
   verb.enableInputDiffusion(plateDiffusionEnabled);
+  verbBypass.setKillTail(kKillVerbTailOnBypass);
   verb.setInputFilterLowCutoffPitch(plateInputDampLow);
   verb.setTankFilterLowCutFrequency(plateTankDampLow);
 
@@ -573,6 +616,14 @@ int main() {
   } else {
     hw.StartAudio(AudioCallback);
   }
+
+  // SDRAM isn't cleared at boot. Zero the delay lines and the plate's memory
+  // with the audio already passing dry rather than keeping the pedal silent
+  // until it's done.
+  delay->Init();
+  while (!delayPlacement.clearSome()) {
+  }
+  delay_memory_cleared = true;
   
   while (true) {
     if(trigger_settings_save) {
@@ -0,0 +1,172 @@
+/*
+ * Block stereo delay for Hothouse DSP Platform
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef CMC_STEREO_DELAY_H
+#define CMC_STEREO_DELAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace clevelandmusicco {
+
+/**
+ * Two delay lines with one delay time and one feedback, run a block at a
+ * time.
+ *
+ * It sounds the same as a pair of daisysp::DelayLines, each smoothing the
+ * delay time with fonepole() and calling SetDelay(), Read() and
+ * Write(feedback * read + in) every sample. Both channels follow the same
+ * smoothed delay time, so that's worked out once per block for the two of
+ * them. Each channel is then read for the whole block and written for the
+ * whole block, in loops without a modulo in them, split where the write
+ * position wraps round the start of the line.
+ *
+ * That only works while the delay is longer than the block, or the block
+ * would read what it has just written. A shorter delay, such as the first
+ * few samples after Init() while the delay time glides up from 0, is run a
+ * sample at a time instead.
+ *
+ * The delay time still glides with the per-sample one-pole rather than a
+ * straight line per block, and every read still wraps on its own. A straight
+ * line would change how the delay pitches when its time is moved, which is
+ * what this is meant to keep. And while the time glides the read position
+ * doesn't step back exactly one sample per sample, so a block's reads have no
+ * single wrap point to split at the way its writes do.
+ */
+template <size_t kMaxDelay>
+class StereoDelay {
+ public:
+  /** Most samples worked out at once. Longer blocks are split. */
+  static const size_t kMaxBlock = 32;
+
+  /** Per sample, as for fonepole(). */
+  static constexpr float kSmoothing = 0.0002f;
+
+  /** Zeroes both lines and starts the delay time from 0 again. Doesn't touch
+   * the target delay time or the feedback. */
+  void Init() {
+    for (size_t i = 0; i < kMaxDelay; ++i) {
+      left_[i] = 0.0f;
+      right_[i] = 0.0f;
+    }
+    write_ptr_ = 0;
+    current_delay_ = 0.0f;
+  }
+
+  /** The delay time in samples the current one glides to. */
+  void SetDelay(float samples) { target_delay_ = samples; }
+
+  void SetFeedback(float feedback) { feedback_ = feedback; }
+
+  /** Feeds `size` samples of input through the lines and writes what comes
+   * out of them, the wet signal without any dry, to `wet_left` and
+   * `wet_right`. Those can't be the input buffers. */
+  void Process(const float *in_left, const float *in_right, float *wet_left,
+               float *wet_right, size_t size) {
+    for (size_t start = 0; start < size; start += kMaxBlock) {
+      const size_t n = size - start < kMaxBlock ? size - start : kMaxBlock;
+      ProcessBlock(in_left + start, in_right + start, wet_left + start,
+                   wet_right + start, n);
+    }
+  }
+
+ private:
+  void ProcessBlock(const float *in_left, const float *in_right,
+                    float *wet_left, float *wet_right, size_t size) {
+    // The smoothed delay time for each sample, as SetDelay(float) splits it.
+    bool overlaps = false;
+    for (size_t k = 0; k < size; ++k) {
+      current_delay_ += kSmoothing * (target_delay_ - current_delay_);
+      const int32_t whole = static_cast<int32_t>(current_delay_);
+      fraction_[k] = current_delay_ - static_cast<float>(whole);
+      whole_[k] = static_cast<size_t>(whole) < kMaxDelay ? whole
+                                                         : kMaxDelay - 1;
+      // Sample k's read would find what sample k - whole_[k] wrote.
+      overlaps |= whole_[k] <= k;
+    }
+
+    if (overlaps) {
+      for (size_t k = 0; k < size; ++k) {
+        wet_left[k] = ReadAt(left_, write_ptr_, k);
+        wet_right[k] = ReadAt(right_, write_ptr_, k);
+        left_[write_ptr_] = feedback_ * wet_left[k] + in_left[k];
+        right_[write_ptr_] = feedback_ * wet_right[k] + in_right[k];
+        write_ptr_ = write_ptr_ == 0 ? kMaxDelay - 1 : write_ptr_ - 1;
+      }
+      return;
+    }
+
+    // Samples before the write position wraps round to the end of the line.
+    const size_t before_wrap = write_ptr_ + 1 < size ? write_ptr_ + 1 : size;
+    ProcessLine(left_, in_left, wet_left, size, before_wrap);
+    ProcessLine(right_, in_right, wet_right, size, before_wrap);
+    write_ptr_ = write_ptr_ >= size ? write_ptr_ - size
+                                    : write_ptr_ + kMaxDelay - size;
+  }
+
+  // One channel's block, all of its reads and then all of its writes.
+  // Sample k writes to `top - k`, where `top` is write_ptr_ for the samples
+  // before the wrap and write_ptr_ plus the line's length after it.
+  void ProcessLine(float *line, const float *in, float *wet, size_t size,
+                   size_t before_wrap) {
+    const size_t top = write_ptr_;
+    for (size_t k = 0; k < before_wrap; ++k) {
+      wet[k] = ReadAt(line, top - k, k);
+    }
+    for (size_t k = before_wrap; k < size; ++k) {
+      wet[k] = ReadAt(line, top + kMaxDelay - k, k);
+    }
+
+    const float feedback = feedback_;
+    for (size_t k = 0; k < before_wrap; ++k) {
+      line[top - k] = feedback * wet[k] + in[k];
+    }
+    for (size_t k = before_wrap; k < size; ++k) {
+      line[top + kMaxDelay - k] = feedback * wet[k] + in[k];
+    }
+  }
+
+  // What Read() gives with the write position at `write` and sample k's
+  // delay time.
+  float ReadAt(const float *line, size_t write, size_t k) const {
+    size_t a = write + whole_[k];
+    a = a >= kMaxDelay ? a - kMaxDelay : a;
+    const size_t b = a + 1 == kMaxDelay ? 0 : a + 1;
+    return line[a] + (line[b] - line[a]) * fraction_[k];
+  }
+
+  float left_[kMaxDelay];
+  float right_[kMaxDelay];
+  size_t write_ptr_ = 0;
+
+  float current_delay_ = 0.0f;
+  float target_delay_ = 0.0f;
+  float feedback_ = 0.0f;
+
+  // The block's delay times, shared by both channels
+  size_t whole_[kMaxBlock];
+  float fraction_[kMaxBlock];
+};
+
+}  // namespace clevelandmusicco
+
+#endif  // CMC_STEREO_DELAY_H
@@ -2,13 +2,19 @@
 
 #include "common.hpp"
 #include "fx_engine.hpp"
-#include <ranges>
 
+// Runs on delay memory in `format` (see Format).
+template <Format format = FORMAT_32_BIT>
 class AllPassDemo {
   constexpr static size_t max_excursion = 16;
 
  public:
-  AllPassDemo(Buffer buffer) : engine_{buffer} {};
+  constexpr static Format kFormat = format;
+
+  // The allpass at its longest. set_size() shortens it.
+  using Memory = FxEngineBase::Topology<FxEngineBase::Reserve<4453>>;
+
+  AllPassDemo(StorageBuffer<format> buffer) : engine_{buffer} {};
   ~AllPassDemo() = default;
 
   void Init(float sample_rate) {
@@ -16,26 +22,29 @@ class AllPassDemo {
     engine_.SetLFOFrequency(LFO_2, 0.3f / sample_rate);
   }
 
-  void Process(StereoSignal in, StereoBuffer out) {
-    typename FxEngine::Context c;
-
-    typename FxEngine::AllPass ap1(4453 * size_);
+  // Writes the final mix to `out`, which can be `in`.
+  void Process(StereoIn in, StereoOut out) {
+    FxEngineBase::Context c;
 
-    FxEngine::ConstructTopology(engine_, {&ap1});
+    AllPass<0> ap1(engine_);
+    const int32_t tail = static_cast<int32_t>(
+        static_cast<size_t>(Memory::kLength[0] * size_) - 1);
 
     const float kid1 = diffusion_;  // input diffusion 1
 
     const float amount = amount_;
 
-    for (auto&& [in_s, out_s] : std::views::zip(in, out)) {
+    for (size_t n = 0; n < in.size(); ++n) {
+      const float in_left = in.left(n);
+      const float in_right = in.right(n);
       engine_.Advance();
 
-      c.Set((in_s.left + in_s.right) * input_gain_);
-      ap1.Process(c, kid1);
-      const float out = c.Get();
+      c.Set((in_left + in_right) * input_gain_);
+      ap1.Process(c, kid1, tail);
+      const float wet = c.Get();
 
-      out_s.left += (out - in_s.left) * amount;
-      out_s.right += (out - in_s.right) * amount;
+      out.left(n) = in_left + (wet - in_left) * amount;
+      out.right(n) = in_right + (wet - in_right) * amount;
     }
   }
 
@@ -47,8 +56,17 @@ class AllPassDemo {
 
   inline void set_size(float size) { size_ = size; }
 
+  // Clears the delay memory a piece at a time, from the audio callback while
+  // the engine isn't running (see FxEngine::ClearSome()).
+  inline void StartClear() { engine_.StartClear(); }
+
+  inline bool ClearSome(size_t length) { return engine_.ClearSome(length); }
+
  private:
-  FxEngine engine_;
+  template <size_t kIndex>
+  using AllPass = typename FxEngine<format>::template AllPass<Memory, kIndex>;
+
+  FxEngine<format> engine_;
 
   float size_ = 1.f;
   float amount_ = 0.f;
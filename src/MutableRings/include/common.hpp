@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <span>
 
 struct StereoSample {
@@ -6,6 +7,52 @@ struct StereoSample {
   float right;
 };
 
-using Buffer = std::span<float>;
-using StereoBuffer = std::span<StereoSample>;
-using StereoSignal = std::span<const StereoSample>;
+// Every FxEngine's ring buffer is this long, so the wrap is a constant mask.
+constexpr size_t kDelayBufferLength = 32768;
+
+using Buffer = std::span<float, kDelayBufferLength>;
+
+// A block of stereo audio left where it is, either interleaved (L R L R ...,
+// as from the interleaved audio callback or in StereoSample) or planar (a
+// buffer per channel, as from the non-interleaved one). The engines read
+// their input and write their final mix through it, so neither layout has
+// to be copied or converted first.
+template <typename T>
+class StereoView {
+ public:
+  static constexpr StereoView Interleaved(T* samples, size_t frames) {
+    return StereoView(samples, samples + 1, 2, frames);
+  }
+
+  static constexpr StereoView Planar(T* left, T* right, size_t frames) {
+    return StereoView(left, right, 1, frames);
+  }
+
+  template <typename Sample>
+  static StereoView Interleaved(std::span<Sample> frames) {
+    return Interleaved(&frames.data()->left, frames.size());
+  }
+
+  [[nodiscard]] constexpr size_t size() const { return frames_; }
+
+  constexpr T& left(size_t frame) const { return left_[frame * stride_]; }
+  constexpr T& right(size_t frame) const { return right_[frame * stride_]; }
+
+  [[nodiscard]] constexpr StereoView subview(size_t start,
+                                             size_t count) const {
+    return StereoView(left_ + start * stride_, right_ + start * stride_,
+                      stride_, count);
+  }
+
+ private:
+  constexpr StereoView(T* left, T* right, size_t stride, size_t frames)
+      : left_(left), right_(right), stride_(stride), frames_(frames) {}
+
+  T* left_;
+  T* right_;
+  size_t stride_;
+  size_t frames_;
+};
+
+using StereoIn = StereoView<const float>;
+using StereoOut = StereoView<float>;
@@ -3,6 +3,7 @@
 // CPU use. Fixed frequency.
 
 #pragma once
+#include <algorithm>
 #include <cmath>
 #include <numbers>
 
@@ -16,16 +17,28 @@ class CosineOscillator {
 
   template <Mode mode=Mode::APPROX>
   inline void Init(float frequency) {
-    if constexpr (mode == Mode::APPROX) {
-      InitApproximate(frequency);
-    }
-    else {
-      iir_coefficient_ = 2.0f * std::cos(2.0f * std::numbers::pi_v<float> * frequency);
-      initial_amplitude_ = iir_coefficient_ * 0.25f;
-    }
+    SetCoefficient<mode>(frequency);
     Start();
   }
 
+  // Changes the frequency without restarting: the oscillator carries on
+  // from the phase and level it has got to.
+  template <Mode mode=Mode::APPROX>
+  inline void SetFrequency(float frequency) {
+    // y[1] and y[0] are 0.5 cos(phase) and 0.5 cos(phase - step), and the
+    // coefficient is 2 cos(step).
+    const float old_cos = 0.5f * iir_coefficient_;
+    const float old_sin = std::sqrt(std::max(1.0f - old_cos * old_cos, 0.0f));
+    SetCoefficient<mode>(frequency);
+    if (old_sin == 0.0f) {
+      return;
+    }
+    const float new_cos = 0.5f * iir_coefficient_;
+    const float new_sin = std::sqrt(std::max(1.0f - new_cos * new_cos, 0.0f));
+    const float sin_phase = (y[0] - y[1] * old_cos) / old_sin;
+    y[0] = y[1] * new_cos + sin_phase * new_sin;
+  }
+
   inline void InitApproximate(float frequency) {
     float sign = 16.0f;
     frequency -= 0.25f;
@@ -42,6 +55,17 @@ class CosineOscillator {
     initial_amplitude_ = iir_coefficient_ * 0.25f;
   }
 
+  template <Mode mode>
+  inline void SetCoefficient(float frequency) {
+    if constexpr (mode == Mode::APPROX) {
+      InitApproximate(frequency);
+    }
+    else {
+      iir_coefficient_ = 2.0f * std::cos(2.0f * std::numbers::pi_v<float> * frequency);
+      initial_amplitude_ = iir_coefficient_ * 0.25f;
+    }
+  }
+
   inline void Start() {
     y[0] = initial_amplitude_;
     y[1] = 0.5f;
@@ -1,44 +1,134 @@
 #pragma once
 
-#include <ranges>
+#include <algorithm>
+#include <array>
 
 #include "common.hpp"
 #include "fx_engine.hpp"
 
 
+// Runs on delay memory in `format` (see Format).
+template <Format format = FORMAT_32_BIT>
 class DatorroPlate {
   constexpr static size_t max_excursion = 16;
 
+  // Samples whose output taps are gathered in one go. Has to stay below the
+  // shortest tap (121).
+  constexpr static size_t tap_chunk = 48;
+  static_assert(tap_chunk <= FxEngineBase::kMaxLFOBlock,
+                "the LFOs are rendered a chunk at a time");
+
+  // The output taps, in the order they sit in the buffer.
+  enum OutputTap {
+    DEL1A_353,
+    DEL1A_1990,
+    DEL1A_3627,
+    DAP1B_187,
+    DAP1B_1228,
+    DEL1B_1066,
+    DEL1B_2673,
+    DEL2A_266,
+    DEL2A_2111,
+    DEL2A_2974,
+    DAP2B_335,
+    DAP2B_1913,
+    DEL2B_121,
+    DEL2B_1996,
+    NUM_OUTPUT_TAPS
+  };
+
  public:
-  DatorroPlate(Buffer buffer) : engine_{buffer} {};
+  constexpr static Format kFormat = format;
+
+  // The delays, in the order they sit in the buffer: the four input
+  // diffusers (ap1 to ap4), then dap1a, del1a, dap1b and del1b, then dap2a,
+  // del2a, dap2b and del2b. The modulated allpasses are read with
+  // interpolation, and the output taps add to the ones they're read from.
+  using Memory = FxEngineBase::Topology<
+      FxEngineBase::Reserve<142>, FxEngineBase::Reserve<107>,
+      FxEngineBase::Reserve<379>, FxEngineBase::Reserve<277>,
+      FxEngineBase::Reserve<672 + max_excursion, 3>,
+      FxEngineBase::Reserve<4453, 5>, FxEngineBase::Reserve<1800, 4>,
+      FxEngineBase::Reserve<3720, 4>,
+      FxEngineBase::Reserve<908 + max_excursion, 3>,
+      FxEngineBase::Reserve<4217, 5>, FxEngineBase::Reserve<2656, 4>,
+      FxEngineBase::Reserve<3163, 4>>;
+
+  DatorroPlate(StorageBuffer<format> buffer) : engine_{buffer} {};
   ~DatorroPlate() = default;
 
   void Init(float sample_rate) {
     engine_.SetLFOFrequency(LFO_1, 0.5f / sample_rate);
     engine_.SetLFOFrequency(LFO_2, 0.3f / sample_rate);
+    lp_decay_1_ = 0.0f;
+    lp_decay_2_ = 0.0f;
+    lp_band_ = 0.0f;
+  }
+
+  // Writes the final mix to `out`, which can be `in`.
+  void Process(StereoIn in, StereoOut out) {
+    if (engine_.quality() == FxEngineBase::QUALITY_LOW) {
+      ProcessBlock<true>(in, out);
+    } else {
+      ProcessBlock<false>(in, out);
+    }
   }
 
-  void Process(StereoSignal in, StereoBuffer out) {
-    typename FxEngine::Context c;
+  inline void set_amount(float amount) { amount_ = amount; }
+
+  inline void set_input_gain(float input_gain) { input_gain_ = input_gain; }
+
+  inline void set_time(float reverb_time) { reverb_time_ = reverb_time; }
+
+  inline void set_diffusion(float diffusion) { diffusion_ = diffusion; }
+
+  inline void set_lp(float lp) { lp_ = lp; }
+
+  // See FxEngineBase::Quality. The low tier fades ap2 and ap4 out.
+  inline void set_quality(FxEngineBase::Quality quality) {
+    engine_.SetQuality(quality);
+  }
 
-    typename FxEngine::AllPass ap1(142);
-    typename FxEngine::AllPass ap2(107);
-    typename FxEngine::AllPass ap3(379);
-    typename FxEngine::AllPass ap4(277);
+  inline void Clear() { engine_.Clear(); }
 
-    typename FxEngine::AllPass dap1a(672 + max_excursion);
-    typename FxEngine::DelayLine del1a(4453);
-    typename FxEngine::AllPass dap1b(1800);
-    typename FxEngine::DelayLine del1b(3720);
+  // Clear() a piece at a time, from the audio callback while the engine isn't
+  // running (see FxEngine::ClearSome()).
+  inline void StartClear() {
+    engine_.StartClear();
+    lp_decay_1_ = 0.0f;
+    lp_decay_2_ = 0.0f;
+    lp_band_ = 0.0f;
+  }
 
-    typename FxEngine::AllPass dap2a(908 + max_excursion);
-    typename FxEngine::DelayLine del2a(4217);
-    typename FxEngine::AllPass dap2b(2656);
-    typename FxEngine::DelayLine del2b(3163);
+  inline bool ClearSome(size_t length) { return engine_.ClearSome(length); }
 
-    FxEngine::ConstructTopology(
-        engine_, {&ap1, &ap2, &ap3, &ap4, &dap1a, &del1a, &dap1b, &del1b,
-                  &dap2a, &del2a, &dap2b, &del2b});
+ private:
+  template <size_t kIndex, bool kNearest = false>
+  using AllPass = typename FxEngine<format>::template AllPass<Memory, kIndex,
+                                                              true, kNearest>;
+  template <size_t kIndex>
+  using DelayLine =
+      typename FxEngine<format>::template DelayLine<Memory, kIndex>;
+
+  // Process() with the tier's modulated reads (see FxEngine::DelayLine).
+  template <bool kNearest>
+  void ProcessBlock(StereoIn in, StereoOut out) {
+    FxEngineBase::Context c;
+
+    AllPass<0> ap1(engine_);
+    AllPass<1> ap2(engine_);
+    AllPass<2> ap3(engine_);
+    AllPass<3> ap4(engine_);
+
+    AllPass<4, kNearest> dap1a(engine_);
+    DelayLine<5> del1a(engine_);
+    AllPass<6> dap1b(engine_);
+    DelayLine<7> del1b(engine_);
+
+    AllPass<8, kNearest> dap2a(engine_);
+    DelayLine<9> del2a(engine_);
+    AllPass<10> dap2b(engine_);
+    DelayLine<11> del2b(engine_);
 
     const float kdecay = reverb_time_;  // 0.5f
     const float kid1 = 0.750f;          // input diffusion 1
@@ -52,69 +142,107 @@ class DatorroPlate {
 
     const float amount = amount_;
     const float gain = input_gain_;
+    if (engine_.TakeDiffuserClear()) {
+      ap2.Clear();
+      ap4.Clear();
+    }
+    const FxEngineBase::Diffusers diffusers = engine_.diffusers();
 
     float lp_1 = lp_decay_1_;
     float lp_2 = lp_decay_2_;
     float lp_band = lp_band_;
 
-    for (auto&& [in_s, out_s] : std::views::zip(in, out)) {
-      engine_.Advance();
-
-      c.Set((in_s.left + in_s.right) * gain);
-
-      c.Lp(lp_band, kbandwidth);
-
-      // Diffuse through 4 allpasses.
-      ap1.Process(c, kid1);
-      ap2.Process(c, kid1);
-      ap3.Process(c, kid2);
-      ap4.Process(c, kid2);
-      float apout = c.Get();
-
-      // Main reverb loop.
-      c.Set(apout);
-      dap1a.Interpolate(c, 672.0f, LFO_2, max_excursion, -kdd1);
-      del1a.Process(c);
-      c.Lp(lp_1, kdamp);  // damping
-      c.Multiply(kdecay);
-      dap1b.Process(c, kdd2);
-      del1b.Process(c);
-      c.Multiply(kdecay);
-      c.Add(apout);
-      dap2a.Write(c, kdd2);
-
-      c.Set(apout);
-      dap2a.Interpolate(c, 908.0f, LFO_1, max_excursion, -kdd1);
-      del2a.Process(c);
-      c.Lp(lp_1, kdamp);  // damping
-      c.Multiply(kdecay);
-      dap2b.Process(c, kdd2);
-      del2b.Process(c);
-      c.Multiply(kdecay);
-      c.Add(apout);
-      dap1a.Write(c, kdd1);
-
-      float left_sum = 0;
-      left_sum += 0.6f * del2a.at(266);
-      left_sum += 0.6f * del2a.at(2974);
-      left_sum -= 0.6f * dap2b.at(1913);
-      left_sum += 0.6f * del2b.at(1996);
-      left_sum -= 0.6f * del1a.at(1990);
-      left_sum -= 0.6f * dap1b.at(187);
-      left_sum -= 0.6f * del1b.at(1066);
-
-      out_s.left += (left_sum - in_s.left) * amount;
-
-      float right_sum = 0;
-      right_sum += 0.6f * del1a.at(353);
-      right_sum += 0.6f * del1a.at(3627);
-      right_sum -= 0.6f * dap1b.at(1228);
-      right_sum += 0.6f * del1b.at(2673);
-      right_sum -= 0.6f * del2a.at(2111);
-      right_sum -= 0.6f * dap2b.at(335);
-      right_sum -= 0.6f * del2b.at(121);
-
-      out_s.right += (right_sum - in_s.right) * amount;
+    // Each output tap is read a chunk at a time before the chunk runs, in
+    // buffer order, rather than scattered through every sample. Where each
+    // one is, from the write pointer, is known at compile time.
+    constexpr std::array<size_t, NUM_OUTPUT_TAPS> output_taps = {
+        del1a.base + 353,  del1a.base + 1990, del1a.base + 3627,
+        dap1b.base + 187,  dap1b.base + 1228, del1b.base + 1066,
+        del1b.base + 2673, del2a.base + 266,  del2a.base + 2111,
+        del2a.base + 2974, dap2b.base + 335,  dap2b.base + 1913,
+        del2b.base + 121,  del2b.base + 1996};
+    std::array<std::array<float, tap_chunk>, NUM_OUTPUT_TAPS> taps;
+
+    for (size_t start = 0; start < in.size(); start += tap_chunk) {
+      const size_t count = std::min(tap_chunk, in.size() - start);
+      for (size_t t = 0; t < NUM_OUTPUT_TAPS; ++t) {
+        engine_.Gather(output_taps[t], std::span(taps[t]).first(count));
+      }
+      for (size_t tap : output_taps) {
+        engine_.Prefetch(tap, count);
+      }
+      engine_.RenderLFOs(count);
+
+      for (size_t n = 0; n < count; ++n) {
+        const float in_left = in.left(start + n);
+        const float in_right = in.right(start + n);
+        engine_.Advance();
+
+        c.Set((in_left + in_right) * gain);
+
+        c.Lp(lp_band, kbandwidth);
+
+        // Diffuse through 4 allpasses (2 on the low tier).
+        ap1.Process(c, kid1);
+        if (diffusers == FxEngineBase::DIFFUSERS_IN) {
+          ap2.Process(c, kid1);
+          ap3.Process(c, kid2);
+          ap4.Process(c, kid2);
+        } else if (diffusers == FxEngineBase::DIFFUSERS_OUT) {
+          ap3.Process(c, kid2);
+        } else {
+          const float mix = engine_.StepDiffuserFade();
+          ap2.ProcessMixed(c, kid1, mix);
+          ap3.Process(c, kid2);
+          ap4.ProcessMixed(c, kid2, mix);
+        }
+        float apout = c.Get();
+
+        // Main reverb loop.
+        c.Set(apout);
+        dap1a.Interpolate(c, 672.0f, LFO_2, max_excursion, -kdd1);
+        del1a.Process(c);
+        c.Lp(lp_1, kdamp);  // damping
+        c.Multiply(kdecay);
+        dap1b.Process(c, kdd2);
+        del1b.Process(c);
+        c.Multiply(kdecay);
+        c.Add(apout);
+        dap2a.Write(c, kdd2);
+
+        c.Set(apout);
+        dap2a.Interpolate(c, 908.0f, LFO_1, max_excursion, -kdd1);
+        del2a.Process(c);
+        c.Lp(lp_1, kdamp);  // damping
+        c.Multiply(kdecay);
+        dap2b.Process(c, kdd2);
+        del2b.Process(c);
+        c.Multiply(kdecay);
+        c.Add(apout);
+        dap1a.Write(c, kdd1);
+
+        float left_sum = 0;
+        left_sum += 0.6f * taps[DEL2A_266][n];
+        left_sum += 0.6f * taps[DEL2A_2974][n];
+        left_sum -= 0.6f * taps[DAP2B_1913][n];
+        left_sum += 0.6f * taps[DEL2B_1996][n];
+        left_sum -= 0.6f * taps[DEL1A_1990][n];
+        left_sum -= 0.6f * taps[DAP1B_187][n];
+        left_sum -= 0.6f * taps[DEL1B_1066][n];
+
+        out.left(start + n) = in_left + (left_sum - in_left) * amount;
+
+        float right_sum = 0;
+        right_sum += 0.6f * taps[DEL1A_353][n];
+        right_sum += 0.6f * taps[DEL1A_3627][n];
+        right_sum -= 0.6f * taps[DAP1B_1228][n];
+        right_sum += 0.6f * taps[DEL1B_2673][n];
+        right_sum -= 0.6f * taps[DEL2A_2111][n];
+        right_sum -= 0.6f * taps[DAP2B_335][n];
+        right_sum -= 0.6f * taps[DEL2B_121][n];
+
+        out.right(start + n) = in_right + (right_sum - in_right) * amount;
+      }
     }
 
     lp_decay_1_ = lp_1;
@@ -122,20 +250,7 @@ class DatorroPlate {
     lp_band_ = lp_band;
   }
 
-  inline void set_amount(float amount) { amount_ = amount; }
-
-  inline void set_input_gain(float input_gain) { input_gain_ = input_gain; }
-
-  inline void set_time(float reverb_time) { reverb_time_ = reverb_time; }
-
-  inline void set_diffusion(float diffusion) { diffusion_ = diffusion; }
-
-  inline void set_lp(float lp) { lp_ = lp; }
-
-  inline void Clear() { engine_.Clear(); }
-
- private:
-  FxEngine engine_;
+  FxEngine<format> engine_;
 
   float amount_ = 0.f;
   float input_gain_ = 1.f;
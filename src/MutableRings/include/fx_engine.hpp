@@ -5,8 +5,11 @@
 #pragma once
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdint>
 #include <span>
 
+#include "common.hpp"
 #include "cosine_oscillator.hpp"
 
 
@@ -24,62 +27,164 @@ constexpr static int32_t TAIL = -1;
 
 enum LFOIndex { LFO_1, LFO_2 };
 
-class FxEngine {
+static_assert((kDelayBufferLength & (kDelayBufferLength - 1)) == 0,
+              "the buffer length has to be a power of two");
+
+// How the delay memory holds its samples, as in the Clouds and Rings engines
+// this one comes from. Floats are exact. The others keep -1 to 1, clip
+// outside of it, and take a half (16 bits) or three eighths (12 bits, two
+// samples packed in three bytes) of the memory and of its bandwidth.
+enum Format { FORMAT_12_BIT, FORMAT_16_BIT, FORMAT_32_BIT };
+
+constexpr size_t BitsPerSample(Format format) {
+  return format == FORMAT_12_BIT ? 12 : format == FORMAT_16_BIT ? 16 : 32;
+}
+
+// What FxEngine::at() gives back for a format that isn't float: a sample
+// that converts on the way in and out.
+template <typename Data>
+class SampleReference {
  public:
-  FxEngine(std::span<float> signal)
-      : buffer_(signal), mask(buffer_.size() - 1){};
-  ~FxEngine() = default;
+  SampleReference(typename Data::T* storage, size_t index)
+      : storage_(storage), index_(index) {}
 
-  void Clear() {
-    std::fill(buffer_.begin(), buffer_.end(), 0);
-    write_ptr_ = 0;
+  operator float() const { return Data::Load(storage_, index_); }
+
+  SampleReference& operator=(float value) {
+    Data::Store(storage_, index_, value);
+    return *this;
   }
 
-  //[gnu::always_inline]
-  void SetLFOFrequency(LFOIndex index, float frequency) {
-    lfos_[index].Init(frequency * 32.0f);
+ private:
+  typename Data::T* storage_;
+  size_t index_;
+};
+
+// Limits a scaled sample to the fixed-point formats' range, -(max + 1) to
+// max, while it's still a float: converting one outside int32_t's range, or
+// NaN, is undefined. NaN comes out as -(max + 1), since std::max() returns
+// its first argument when the comparison fails.
+constexpr float Clamp(float x, float max) {
+  return std::min(std::max(-(max + 1.0f), x), max);
+}
+
+// Each format's storage (T), and its reads and writes of sample `index`.
+template <Format format>
+struct DataType;
+
+template <>
+struct DataType<FORMAT_32_BIT> {
+  using T = float;
+  using Reference = float&;
+
+  static float& At(T* storage, size_t index) { return storage[index]; }
+
+  static float Load(const T* storage, size_t index) { return storage[index]; }
+
+  static const T* Address(const T* storage, size_t index) {
+    return storage + index;
   }
+};
 
-  //[gnu::always_inline]
-  void Advance() {
-    --write_ptr_;
-    if (write_ptr_ < 0) {
-      write_ptr_ += buffer_.size();
-    }
+template <>
+struct DataType<FORMAT_16_BIT> {
+  using T = int16_t;
+  using Reference = SampleReference<DataType>;
+
+  static Reference At(T* storage, size_t index) { return {storage, index}; }
+
+  static float Load(const T* storage, size_t index) {
+    return static_cast<float>(storage[index]) * (1.0f / 32768.0f);
   }
 
-  //[gnu::always_inline]
-  float& at(size_t index) { return buffer_[(write_ptr_ + index) & mask]; }
+  static void Store(T* storage, size_t index, float value) {
+    const auto x = static_cast<int32_t>(Clamp(value * 32768.0f, 32767.0f));
+    storage[index] = static_cast<T>(x);
+  }
 
-  //[gnu::always_inline]
-  void StepLFO() {
-    if ((write_ptr_ & 31) == 0) {
-      for (auto& lfo : lfos_) {
-        lfo.Next();
-      }
-    }
+  static const T* Address(const T* storage, size_t index) {
+    return storage + index;
   }
+};
 
-  //[gnu::always_inline]
-  float LFO(LFOIndex lfo) {
-    StepLFO();
-    switch (lfo) {
-      case LFO_1:
-        return lfos_[0].value();
-      case LFO_2:
-        return lfos_[1].value();
+// Sample 2n is byte 3n and the low nibble of byte 3n + 1, sample 2n + 1 the
+// high nibble of that and byte 3n + 2.
+template <>
+struct DataType<FORMAT_12_BIT> {
+  using T = uint8_t;
+  using Reference = SampleReference<DataType>;
+
+  static Reference At(T* storage, size_t index) { return {storage, index}; }
+
+  static float Load(const T* storage, size_t index) {
+    const T* p = Address(storage, index);
+    const uint32_t word = p[0] | (p[1] << 8);
+    const uint32_t bits = (index & 1) ? word >> 4 : word & 0xfff;
+    const int32_t x = static_cast<int32_t>(bits << 20) >> 20;
+    return static_cast<float>(x) * (1.0f / 2048.0f);
+  }
+
+  static void Store(T* storage, size_t index, float value) {
+    const auto x = static_cast<int32_t>(Clamp(value * 2048.0f, 2047.0f));
+    const auto bits = static_cast<uint32_t>(x) & 0xfff;
+    T* p = storage + index + (index >> 1);
+    if (index & 1) {
+      p[0] = static_cast<T>((p[0] & 0x0f) | (bits << 4));
+      p[1] = static_cast<T>(bits >> 4);
+    } else {
+      p[0] = static_cast<T>(bits);
+      p[1] = static_cast<T>((p[1] & 0xf0) | (bits >> 8));
     }
-    __builtin_unreachable();
   }
 
- private:
-  int32_t write_ptr_ = 0;
-  std::span<float> buffer_;
-  std::array<CosineOscillator, 2> lfos_;
+  static const T* Address(const T* storage, size_t index) {
+    return storage + index + (index >> 1);
+  }
+};
 
-  size_t mask;
+// How many T's of a format's storage hold `samples` samples.
+template <Format format>
+constexpr size_t StorageLength(size_t samples) {
+  return samples * BitsPerSample(format) / 8 /
+         sizeof(typename DataType<format>::T);
+}
+
+// An engine's delay memory in a given format: kDelayBufferLength samples,
+// in 128 KB as floats, 64 KB as 16 bits or 48 KB as 12.
+template <Format format>
+using StorageArray = std::array<typename DataType<format>::T,
+                                StorageLength<format>(kDelayBufferLength)>;
+template <Format format>
+using StorageBuffer = std::span<typename DataType<format>::T,
+                                StorageLength<format>(kDelayBufferLength)>;
+
+// What FxEngine is, whatever its format.
+class FxEngineBase {
+ public:
+  // How much CPU the reverbs spend on sounding their best:
+  //
+  //   QUALITY_HIGH    Modulated reads are interpolated and the LFOs step
+  //                   every 32 samples.
+  //   QUALITY_MEDIUM  The LFOs step every 128 samples.
+  //   QUALITY_LOW     Modulated reads take the nearest sample, the LFOs step
+  //                   every 256 samples and the reverbs run half of their
+  //                   input diffusers.
+  //
+  // The tier can be changed while the engine runs. The diffusers the low
+  // tier leaves out fade in and out over kDiffuserFadeSamples (see
+  // FxEngine::diffusers()).
+  enum Quality { QUALITY_LOW, QUALITY_MEDIUM, QUALITY_HIGH };
+
+  // How a reverb runs the input diffusers that the low tier leaves out.
+  enum Diffusers { DIFFUSERS_OUT, DIFFUSERS_IN, DIFFUSERS_FADING };
+
+  // 10 ms at 48 kHz.
+  static constexpr float kDiffuserFadeSamples = 480.0f;
+
+  // The most samples RenderLFOs() covers. Longer blocks are processed in
+  // pieces of at most this.
+  static constexpr size_t kMaxLFOBlock = 64;
 
- public: /******************** INNER CLASSES ****************/
   class Context {
    public:
     [[nodiscard]] constexpr float Get() const { return accumulator_; }
@@ -100,8 +205,315 @@ class FxEngine {
     float accumulator_ = 0.f;
   };
 
+  // A delay's place in the buffer, for Topology.
+  //   kLength    Samples of delay.
+  //   kAccesses  Reads and writes of it per sample, output taps included.
+  //              Only for the count in Topology.
+  template <size_t kLength, size_t kAccesses = 2>
+  struct Reserve {};
+
+  // Lays the delays out one after another in the buffer at compile time,
+  // each with a sample to spare, so that every address is a constant offset
+  // from the write pointer:
+  //
+  //   using Memory = FxEngineBase::Topology<FxEngineBase::Reserve<150>,
+  //                                         FxEngineBase::Reserve<4501, 3>>;
+  //   FxEngine<>::AllPass<Memory, 0> ap1(engine);
+  //   FxEngine<>::DelayLine<Memory, 1> del1(engine);
+  //
+  // A topology that doesn't fit the buffer doesn't compile. Bytes() and
+  // kAccessesPerSample are what the reverb costs in memory, in a given
+  // format, and in delay reads and writes per sample.
+  template <typename... Delays>
+  struct Topology;
+
+  template <size_t... kLengths, size_t... kAccesses>
+  struct Topology<Reserve<kLengths, kAccesses>...> {
+    static constexpr size_t kNumDelays = sizeof...(kLengths);
+    static constexpr std::array<size_t, kNumDelays> kLength = {kLengths...};
+    static constexpr std::array<size_t, kNumDelays> kBase = [] {
+      std::array<size_t, kNumDelays> base = {};
+      size_t next = 0;
+      for (size_t d = 0; d < kNumDelays; ++d) {
+        base[d] = next;
+        next += kLength[d] + 1;
+      }
+      return base;
+    }();
+    static constexpr size_t kSize = ((kLengths + 1) + ... + 0);
+    static constexpr size_t Bytes(Format format) {
+      return kSize * BitsPerSample(format) / 8;
+    }
+    static constexpr size_t kAccessesPerSample = (kAccesses + ... + 0);
+
+    static_assert(kSize <= kDelayBufferLength, "delay memory full");
+  };
+};
+
+template <Format format = FORMAT_32_BIT>
+class FxEngine : public FxEngineBase {
+  using Data = DataType<format>;
+
+ public:
+  FxEngine(StorageBuffer<format> signal) : buffer_(signal){};
+  ~FxEngine() = default;
+
+  void Clear() {
+    std::fill(buffer_.begin(), buffer_.end(), 0);
+    write_ptr_ = 0;
+    ResetDiffusers();
+  }
+
+  // Clear() a piece at a time, for clearing from the audio callback while
+  // the engine isn't running: StartClear(), then ClearSome() once per block
+  // until it returns true. Each call zeroes at most `length` samples.
+  void StartClear() { clear_offset_ = 0; }
+
+  bool ClearSome(size_t length) {
+    const size_t end =
+        std::min(clear_offset_ + StorageLength<format>(length), buffer_.size());
+    std::fill(buffer_.begin() + clear_offset_, buffer_.begin() + end, 0);
+    clear_offset_ = end;
+    if (clear_offset_ < buffer_.size()) {
+      return false;
+    }
+    write_ptr_ = 0;
+    ResetDiffusers();
+    return true;
+  }
+
+  // `frequency` is in cycles per sample. Restarts the LFO.
+  void SetLFOFrequency(LFOIndex index, float frequency) {
+    lfo_frequencies_[index] = frequency;
+    lfos_[index].Init(frequency * static_cast<float>(lfo_period_));
+    lfo_value_[index] = lfo_target_[index] = lfos_[index].value();
+    lfo_slope_[index] = 0.0f;
+    lfo_phase_ = lfo_period_;
+  }
+
+  // How many samples apart the LFOs are worked out, with a straight line
+  // in between. Restarts the LFOs.
+  void SetLFOPeriod(size_t samples) {
+    lfo_period_ = next_lfo_period_ = std::max<size_t>(samples, 1);
+    for (size_t i = 0; i < lfos_.size(); ++i) {
+      SetLFOFrequency(static_cast<LFOIndex>(i), lfo_frequencies_[i]);
+    }
+  }
+
+  // Can be called every block. A new tier's LFO period starts at the LFOs'
+  // next step, and they carry on from where they are.
+  void SetQuality(Quality quality) {
+    if (quality == quality_) {
+      return;
+    }
+    if (quality == QUALITY_LOW) {
+      diffuser_fade_dir_ = -1.0f;
+      clear_diffusers_ = false;
+    } else if (quality_ == QUALITY_LOW) {
+      diffuser_fade_dir_ = 1.0f;
+      clear_diffusers_ = diffuser_fade_ == 0.0f;
+    }
+    quality_ = quality;
+    next_lfo_period_ = quality == QUALITY_HIGH     ? 32
+                       : quality == QUALITY_MEDIUM ? 128
+                                                   : 256;
+  }
+
+  [[nodiscard]] Quality quality() const { return quality_; }
+
+  // How the reverb runs the diffusers the low tier leaves out, for the rest
+  // of the run it's about to process.
+  [[nodiscard]] Diffusers diffusers() const {
+    if (diffuser_fade_ == 1.0f && diffuser_fade_dir_ > 0.0f) {
+      return DIFFUSERS_IN;
+    }
+    if (diffuser_fade_ == 0.0f && diffuser_fade_dir_ < 0.0f) {
+      return DIFFUSERS_OUT;
+    }
+    return DIFFUSERS_FADING;
+  }
+
+  // Whether the diffusers have to be cleared before they fade back in. They
+  // don't run while they're out, so their memory holds whatever went
+  // through that part of the buffer. True once per fade in.
+  bool TakeDiffuserClear() {
+    const bool clear = clear_diffusers_;
+    clear_diffusers_ = false;
+    return clear;
+  }
+
+  // The next sample's mix of the diffusers while they're fading, from 0 for
+  // bypassed to 1 for all in.
+  float StepDiffuserFade() {
+    diffuser_fade_ = std::clamp(
+        diffuser_fade_ + diffuser_fade_dir_ / kDiffuserFadeSamples, 0.0f,
+        1.0f);
+    return diffuser_fade_;
+  }
+
+  // With kWraps false, only for the samples NextRun() says don't wrap.
+  //[gnu::always_inline]
+  template <bool kWraps = true>
+  void Advance() {
+    --write_ptr_;
+    if constexpr (kWraps) {
+      if (write_ptr_ < 0) {
+        write_ptr_ += kDelayBufferLength;
+      }
+    }
+    ++lfo_sample_;
+  }
+
+  // A float& for FORMAT_32_BIT, otherwise something that converts to and
+  // from float on the way. With kWraps false the index isn't masked, which
+  // is only right for the samples NextRun() says don't wrap.
+  //[gnu::always_inline]
+  template <bool kWraps = true>
+  typename Data::Reference at(size_t index) {
+    if constexpr (kWraps) {
+      return Data::At(buffer_.data(), (write_ptr_ + index) & mask);
+    } else {
+      return Data::At(buffer_.data(), write_ptr_ + index);
+    }
+  }
+
+  // How many of the next `size` samples make a run that Memory (a Topology)
+  // can process with the same kind of addressing, and in `wraps`, which
+  // kind. Every address is less than Memory::kSize past the write pointer,
+  // so while that's at least as far from the end of the buffer nothing
+  // wraps and the addresses don't need masking. Process each run with
+  // Advance<kWraps>() and DelayLines or AllPasses with the same kWraps.
+  template <typename Memory>
+  size_t NextRun(size_t size, bool* wraps) const {
+    // The last write pointer where nothing wraps, and the write pointer
+    // after the next Advance().
+    constexpr int32_t kLastWrapFree = kDelayBufferLength - Memory::kSize;
+    const int32_t next =
+        write_ptr_ == 0 ? kDelayBufferLength - 1 : write_ptr_ - 1;
+    *wraps = next > kLastWrapFree;
+    const auto run =
+        static_cast<size_t>(*wraps ? next - kLastWrapFree : next + 1);
+    return std::min(size, run);
+  }
+
+  // Copies what at(index) will be after each of the next out.size() calls to
+  // Advance(), without making them. That's a run backwards through the
+  // buffer from one cursor, instead of a scattered read per sample. Only
+  // valid while nothing writes to those samples in the meantime.
+  void Gather(size_t index, std::span<float> out) const {
+    size_t j = (write_ptr_ + index - 1) & mask;
+    for (float& value : out) {
+      value = Data::Load(buffer_.data(), j);
+      j = (j - 1) & mask;
+    }
+  }
+
+  // Asks the cache for what Gather(index, ...) will read for the `count`
+  // samples after the next `count`.
+  void Prefetch(size_t index, size_t count) const {
+    // 32 bytes on the Cortex-M7
+    constexpr size_t kSamplesPerCacheLine = 256 / BitsPerSample(format);
+    const size_t first = (write_ptr_ + index - 1 - count) & mask;
+    for (size_t n = 0; n < count; n += kSamplesPerCacheLine) {
+      __builtin_prefetch(Data::Address(buffer_.data(), (first - n) & mask));
+    }
+    __builtin_prefetch(
+        Data::Address(buffer_.data(), (first - (count - 1)) & mask));
+  }
+
+  // Works out both LFOs for the next `size` calls to Advance(), so that
+  // LFO() is a lookup however many modulated reads there are. Call before
+  // each block of at most kMaxLFOBlock samples. Each sample is worked out
+  // from the start of its step, so the LFOs come out the same whatever the
+  // block size. A longer block only gets its first kMaxLFOBlock samples.
+  void RenderLFOs(size_t size) {
+    assert(size <= kMaxLFOBlock);
+    size = std::min(size, kMaxLFOBlock);
+    size_t n = 0;
+    while (n < size) {
+      if (lfo_phase_ == lfo_period_) {
+        if (next_lfo_period_ != lfo_period_) {
+          lfo_period_ = next_lfo_period_;
+          for (size_t i = 0; i < lfos_.size(); ++i) {
+            lfos_[i].SetFrequency(lfo_frequencies_[i] *
+                                  static_cast<float>(lfo_period_));
+          }
+        }
+        const float per_sample = 1.0f / static_cast<float>(lfo_period_);
+        for (size_t i = 0; i < lfos_.size(); ++i) {
+          lfo_value_[i] = lfo_target_[i];
+          lfo_target_[i] = lfos_[i].Next();
+          lfo_slope_[i] = (lfo_target_[i] - lfo_value_[i]) * per_sample;
+        }
+        lfo_phase_ = 0;
+      }
+      const size_t run = std::min(size - n, lfo_period_ - lfo_phase_);
+      const auto phase = static_cast<int32_t>(lfo_phase_);
+      for (size_t i = 0; i < lfos_.size(); ++i) {
+        const float value = lfo_value_[i];
+        const float slope = lfo_slope_[i];
+        float* out = &lfo_block_[i][n];
+        for (int32_t k = 0; k < static_cast<int32_t>(run); ++k) {
+          out[k] = value + slope * static_cast<float>(phase + k);
+        }
+      }
+      lfo_phase_ += run;
+      n += run;
+    }
+    lfo_sample_ = -1;
+  }
+
+  // The LFO, from 0 to 1, at the current sample of the block.
+  //[gnu::always_inline]
+  float LFO(LFOIndex lfo) const { return lfo_block_[lfo][lfo_sample_]; }
+
+ private:
+  int32_t write_ptr_ = 0;
+  StorageBuffer<format> buffer_;
+  std::array<CosineOscillator, 2> lfos_;
+  std::array<float, 2> lfo_frequencies_ = {};
+  Quality quality_ = QUALITY_HIGH;
+  size_t lfo_period_ = 32;
+  size_t next_lfo_period_ = 32;
+
+  // Where each LFO was at the start of the current step and where it's
+  // heading, how far into the step it is, and what RenderLFOs() made of it
+  // for the current block.
+  std::array<float, 2> lfo_value_ = {};
+  std::array<float, 2> lfo_target_ = {};
+  std::array<float, 2> lfo_slope_ = {};
+  size_t lfo_phase_ = 32;
+  std::array<std::array<float, kMaxLFOBlock>, 2> lfo_block_ = {};
+  int32_t lfo_sample_ = -1;
+
+  static constexpr size_t mask = kDelayBufferLength - 1;
+  size_t clear_offset_ = 0;
+
+  // See diffusers().
+  float diffuser_fade_ = 1.0f;
+  float diffuser_fade_dir_ = 1.0f;
+  bool clear_diffusers_ = false;
+
+  // Where the diffusers are for the tier once the whole buffer is clear.
+  void ResetDiffusers() {
+    diffuser_fade_ = quality_ == QUALITY_LOW ? 0.0f : 1.0f;
+    diffuser_fade_dir_ = quality_ == QUALITY_LOW ? -1.0f : 1.0f;
+    clear_diffusers_ = false;
+  }
+
+ public: /******************** INNER CLASSES ****************/
+  // Delay kIndex of Memory (a Topology). kWraps is as for at().
+  // With kNearest, Interpolate() takes the nearest sample instead, as the
+  // low tier does.
+  template <typename Memory, size_t kIndex, bool kWraps = true,
+            bool kNearest = false>
   struct DelayLine {
-    DelayLine(size_t length) : length(length){};
+    static_assert(kIndex < Memory::kNumDelays, "no such delay");
+
+    static constexpr size_t length = Memory::kLength[kIndex];
+    static constexpr size_t base = Memory::kBase[kIndex];
+
+    explicit DelayLine(FxEngine& engine) : engine_(&engine){};
 
     // Store and Fetch
     //[gnu::always_inline]
@@ -111,21 +523,23 @@ class FxEngine {
     }
 
     //[gnu::always_inline]
-    float& at(int32_t index) {
+    typename Data::Reference at(int32_t index) {
       if (index == TAIL) {
         index = length - 1;
       }
-      return engine_->at(this->base + index);
+      return engine_->template at<kWraps>(this->base + index);
     }
 
     //[gnu::always_inline]
     float Read(int32_t offset) {
-      // STATIC_ASSERT(d.base + d.length <= size, delay_memory_full);
       return this->at(offset);
     }
 
     //[gnu::always_inline]
     float Interpolate(float offset) {
+      if constexpr (kNearest) {
+        return this->at(static_cast<int32_t>(offset + 0.5f));
+      }
       auto offset_integral = static_cast<int32_t>(offset);
       float offset_fractional = offset - static_cast<float>(offset_integral);
       const float a = this->at(offset_integral);
@@ -137,18 +551,37 @@ class FxEngine {
     //[gnu::always_inline]
     void Write(int32_t offset, float value) { this->at(offset) = value; }
 
+    // Zeroes the delay where it is now.
+    void Clear() {
+      for (size_t i = 0; i < length; ++i) {
+        engine_->template at<true>(this->base + i) = 0.0f;
+      }
+    }
+
+    /// at(index) for each of the next out.size() samples (see
+    /// FxEngine::Gather). `index` has to be at least out.size(), or the
+    /// samples being written would be read.
+    void Gather(int32_t index, std::span<float> out) const {
+      engine_->Gather(this->base + index, out);
+    }
+
+    void Prefetch(int32_t index, size_t count) const {
+      engine_->Prefetch(this->base + index, count);
+    }
+
    public:
-    const size_t length = 0;
-    size_t base = 0;
     FxEngine* engine_ = nullptr;
   };
 
-  struct AllPass : public DelayLine {
-    AllPass(size_t length) : DelayLine(length){};
+  template <typename Memory, size_t kIndex, bool kWraps = true,
+            bool kNearest = false>
+  struct AllPass : public DelayLine<Memory, kIndex, kWraps, kNearest> {
+    using Base = DelayLine<Memory, kIndex, kWraps, kNearest>;
+    using Base::Base;
 
     //[gnu::always_inline]
     float Read(Context& c, int32_t offset, float scale) {
-      const float r = DelayLine::Read(offset);
+      const float r = Base::Read(offset);
       c.Add(r * scale);
       return r;
     }
@@ -157,7 +590,7 @@ class FxEngine {
 
     //[gnu::always_inline]
     void Write(Context& c, int32_t offset, float scale) {
-      DelayLine::Write(offset, c.Get());
+      Base::Write(offset, c.Get());
       c.Multiply(scale);
     }
 
@@ -178,8 +611,7 @@ class FxEngine {
     /** @brief Can be used in place of any AllPass::Read calls */
     //[gnu::always_inline]
     float Interpolate(Context& c, float offset, float scale) {
-      // STATIC_ASSERT(d.base + d.length <= size, delay_memory_full);
-      const float r = DelayLine::Interpolate(offset);
+      const float r = Base::Interpolate(offset);
       c.Add(r * scale);
       return r;
     }
@@ -208,8 +640,24 @@ class FxEngine {
     //
     //[gnu::always_inline]
     void Process(Context& c, float scale) {
+      Process(c, scale, this->length - 1);
+    }
+
+    // Process() partly bypassed, for fading the allpass in and out: `mix` of
+    // its output and the rest of its input.
+    void ProcessMixed(Context& c, float scale, float mix) {
+      const float in = c.Get();
+      Process(c, scale);
+      c.Set(in + (c.Get() - in) * mix);
+    }
+
+    // The same with the tail at `tail_index` rather than at the end of the
+    // delay, for an allpass shorter than the memory reserved for it.
+    //[gnu::always_inline]
+    void Process(Context& c, float scale, int32_t tail_index) {
       const float head = c.Get();
-      const float tail = this->at(TAIL);
+      const float tail =
+          this->engine_->template at<kWraps>(this->base + tail_index);
 
       const float feedback = head + (tail * scale);
       this->at(0) = feedback;  // feedback into delayline
@@ -224,14 +672,4 @@ class FxEngine {
       // c.Add(tail);
     }
   };
-
-  static void ConstructTopology(FxEngine& e,
-                                std::initializer_list<DelayLine*> delays) {
-    size_t base = 0;
-    for (DelayLine* d : delays) {
-      d->engine_ = &e;
-      d->base = base;
-      base += d->length + 1;
-    }
-  }
 };
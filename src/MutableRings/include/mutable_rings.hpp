@@ -4,15 +4,30 @@
 
 #pragma once
 
-#include <ranges>
+#include <algorithm>
 
 #include "common.hpp"
 #include "fx_engine.hpp"
 
 
+// Runs on delay memory in `format` (see Format).
+template <Format format = FORMAT_32_BIT>
 class MutableRings {
  public:
-  MutableRings(Buffer buffer) : engine_{buffer} {};
+  constexpr static Format kFormat = format;
+
+  // The delays, in the order they sit in the buffer: the four input
+  // diffusers (ap1 to ap4), then dap1a, dap1b and del1, then dap2a, dap2b
+  // and del2. The long delays are read with interpolation, so three
+  // accesses a sample.
+  using Memory = FxEngineBase::Topology<
+      FxEngineBase::Reserve<150>, FxEngineBase::Reserve<214>,
+      FxEngineBase::Reserve<319>, FxEngineBase::Reserve<527>,
+      FxEngineBase::Reserve<2182>, FxEngineBase::Reserve<2690>,
+      FxEngineBase::Reserve<4501, 3>, FxEngineBase::Reserve<2525>,
+      FxEngineBase::Reserve<2197>, FxEngineBase::Reserve<6312, 3>>;
+
+  MutableRings(StorageBuffer<format> buffer) : engine_{buffer} {};
   ~MutableRings() = default;
 
   void Init(float sample_rate) {
@@ -20,59 +35,132 @@ class MutableRings {
     engine_.SetLFOFrequency(LFO_2, 0.3f / sample_rate);
     lp_ = 0.7f;
     diffusion_ = 0.625f;
+    lp_decay_1_ = 0.0f;
+    lp_decay_2_ = 0.0f;
   }
 
-  void Process(StereoSignal in, StereoBuffer out) {
+  // Writes the final mix to `out`, which can be `in`.
+  void Process(StereoIn in, StereoOut out) {
+    if (engine_.TakeDiffuserClear()) {
+      AllPass<1, true>(engine_).Clear();
+      AllPass<3, true>(engine_).Clear();
+    }
+    // The LFOs are worked out a piece of the block at a time, and each piece
+    // is split where the delays start or stop wrapping round the end of the
+    // buffer (see FxEngine::NextRun()).
+    const bool nearest = engine_.quality() == FxEngineBase::QUALITY_LOW;
+    for (size_t start = 0; start < in.size();
+         start += FxEngineBase::kMaxLFOBlock) {
+      const size_t end =
+          std::min(start + FxEngineBase::kMaxLFOBlock, in.size());
+      engine_.RenderLFOs(end - start);
+      for (size_t n = start; n < end;) {
+        bool wraps;
+        const size_t run = engine_.template NextRun<Memory>(end - n, &wraps);
+        if (wraps) {
+          nearest ? ProcessRun<true, true>(in, out, n, n + run)
+                  : ProcessRun<true, false>(in, out, n, n + run);
+        } else {
+          nearest ? ProcessRun<false, true>(in, out, n, n + run)
+                  : ProcessRun<false, false>(in, out, n, n + run);
+        }
+        n += run;
+      }
+    }
+  }
+
+  inline void set_amount(float amount) { amount_ = amount; }
+
+  inline void set_input_gain(float input_gain) { input_gain_ = input_gain; }
+
+  inline void set_time(float reverb_time) { reverb_time_ = reverb_time; }
+
+  inline void set_diffusion(float diffusion) { diffusion_ = diffusion; }
+
+  inline void set_lp(float lp) { lp_ = lp; }
+
+  // See FxEngineBase::Quality. The low tier fades ap2 and ap4 out.
+  inline void set_quality(FxEngineBase::Quality quality) {
+    engine_.SetQuality(quality);
+  }
+
+  inline void Clear() { engine_.Clear(); }
+
+  // Clear() a piece at a time, from the audio callback while the engine isn't
+  // running (see FxEngine::ClearSome()).
+  inline void StartClear() {
+    engine_.StartClear();
+    lp_decay_1_ = 0.0f;
+    lp_decay_2_ = 0.0f;
+  }
+
+  inline bool ClearSome(size_t length) { return engine_.ClearSome(length); }
+
+ private:
+  template <size_t kIndex, bool kWraps, bool kNearest = false>
+  using AllPass = typename FxEngine<format>::template AllPass<Memory, kIndex,
+                                                              kWraps, kNearest>;
+
+  // Samples `begin` to `end` of the block, with the addressing NextRun()
+  // gave them and the tier's modulated reads (see FxEngine::DelayLine).
+  template <bool kWraps, bool kNearest>
+  void ProcessRun(StereoIn in, StereoOut out, size_t begin, size_t end) {
     // This is the Griesinger topology described in the Dattorro paper
     // (4 AP diffusers on the input, then a loop of 2x 2AP+1Delay).
     // Modulation is applied in the loop of the first diffuser AP for additional
     // smearing; and to the two long delays for a slow shimmer/chorus effect.
-    typename FxEngine::AllPass ap1(150);
-    typename FxEngine::AllPass ap2(214);
-    typename FxEngine::AllPass ap3(319);
-    typename FxEngine::AllPass ap4(527);
-
-    typename FxEngine::AllPass dap1a(2182);
-    typename FxEngine::AllPass dap1b(2690);
-    typename FxEngine::AllPass del1(4501);
-
-    typename FxEngine::AllPass dap2a(2525);
-    typename FxEngine::AllPass dap2b(2197);
-    typename FxEngine::AllPass del2(6312);
-
-    typename FxEngine::Context c;
-    FxEngine::ConstructTopology(engine_,  //<
-                                {
-                                    &ap1, &ap2, &ap3, &ap4,  //<
-                                    &dap1a, &dap1b, &del1,   //<
-                                    &dap2a, &dap2b, &del2,   //<
-                                });
+    AllPass<0, kWraps> ap1(engine_);
+    AllPass<1, kWraps> ap2(engine_);
+    AllPass<2, kWraps> ap3(engine_);
+    AllPass<3, kWraps> ap4(engine_);
+
+    AllPass<4, kWraps> dap1a(engine_);
+    AllPass<5, kWraps> dap1b(engine_);
+    AllPass<6, kWraps, kNearest> del1(engine_);
+
+    AllPass<7, kWraps> dap2a(engine_);
+    AllPass<8, kWraps> dap2b(engine_);
+    AllPass<9, kWraps, kNearest> del2(engine_);
+
+    FxEngineBase::Context c;
 
     const float kap = diffusion_;
     const float klp = lp_;
     const float krt = reverb_time_;
     const float amount = amount_;
     const float gain = input_gain_;
+    const FxEngineBase::Diffusers diffusers = engine_.diffusers();
 
     float lp_1 = lp_decay_1_;
     float lp_2 = lp_decay_2_;
 
-    for (auto&& [in_s, out_s] : std::views::zip(in, out)) {
+    for (size_t n = begin; n < end; ++n) {
+      const float in_left = in.left(n);
+      const float in_right = in.right(n);
       float wet = 0;
       float apout = 0.0f;
-      engine_.Advance();
+      engine_.template Advance<kWraps>();
 
       // Smear AP1 inside the loop.
       // c.Interpolate(ap1, 10.0f, LFO_1, 80.0f, 1.0f);
       // c.Write(ap1, 100, 0.0f);
 
-      c.Set((in_s.left + in_s.right) * gain);
+      c.Set((in_left + in_right) * gain);
 
-      // Diffuse through 4 allpasses.
+      // Diffuse through 4 allpasses (2 on the low tier).
       ap1.Process(c, kap);
-      ap2.Process(c, kap);
-      ap3.Process(c, kap);
-      ap4.Process(c, kap);
+      if (diffusers == FxEngineBase::DIFFUSERS_IN) {
+        ap2.Process(c, kap);
+        ap3.Process(c, kap);
+        ap4.Process(c, kap);
+      } else if (diffusers == FxEngineBase::DIFFUSERS_OUT) {
+        ap3.Process(c, kap);
+      } else {
+        const float mix = engine_.StepDiffuserFade();
+        ap2.ProcessMixed(c, kap, mix);
+        ap3.Process(c, kap);
+        ap4.ProcessMixed(c, kap, mix);
+      }
       apout = c.Get();
 
       // Main reverb loop.
@@ -84,7 +172,7 @@ class MutableRings {
       del1.Write(c, 2.0f);
       wet = c.Get();
 
-      out_s.left += (wet - in_s.left) * amount;
+      out.left(n) = in_left + (wet - in_left) * amount;
 
       c.Set(apout);
       del1.Interpolate(c, 4460.0f, LFO_1, 40.0f, krt);
@@ -94,27 +182,14 @@ class MutableRings {
       del2.Write(c, 2.0f);
       wet = c.Get();
 
-      out_s.right += (wet - in_s.right) * amount;
+      out.right(n) = in_right + (wet - in_right) * amount;
     }
 
     lp_decay_1_ = lp_1;
     lp_decay_2_ = lp_2;
   }
 
-  inline void set_amount(float amount) { amount_ = amount; }
-
-  inline void set_input_gain(float input_gain) { input_gain_ = input_gain; }
-
-  inline void set_time(float reverb_time) { reverb_time_ = reverb_time; }
-
-  inline void set_diffusion(float diffusion) { diffusion_ = diffusion; }
-
-  inline void set_lp(float lp) { lp_ = lp; }
-
-  inline void Clear() { engine_.Clear(); }
-
- private:
-  FxEngine engine_;
+  FxEngine<format> engine_;
 
   float amount_;
   float input_gain_;
@@ -21,6 +21,7 @@
 
 #include "daisysp.h"
 #include "hothouse.h"
+#include "memory_plan.h"
 #include "ap_demo.hpp"
 #include "common.hpp"
 #include "datorro_plate.hpp"
@@ -29,6 +30,8 @@
 #include <algorithm>
 
 using clevelandmusicco::Hothouse;
+using clevelandmusicco::MemoryNeed;
+using clevelandmusicco::MemoryPlan;
 using daisy::AudioHandle;
 using daisy::Led;
 using daisy::Parameter;
@@ -37,10 +40,52 @@ using daisy::System;
 
 Hothouse hw;
 
-std::array<float, 32768> DSY_SDRAM_BSS delay_line_buffer;
-MutableRings reverb_(delay_line_buffer);
-DatorroPlate plate_(delay_line_buffer);
-AllPassDemo apdemo_(delay_line_buffer);
+// How the engines store their delays (see Format). 16 or 12 bits halve the
+// ring buffer or better, and the bandwidth its reads take, at the cost of a
+// little hiss and of clipping anything past full scale.
+const Format kReverbFormat = FORMAT_32_BIT;
+
+// All of an FxEngine's delays share one ring buffer, so it can only be placed
+// as a whole. At 128 KB (as floats) it fits in AXI SRAM (plain .bss on the Seed), which is
+// a lot faster than SDRAM for the scattered reads the diffusers make. Being
+// .bss, the startup code has already zeroed it by the time main() runs.
+//
+// The toggle runs one engine at a time, so the memory plan gives all three
+// the same buffer. Each needs the whole ring whatever its topology uses,
+// since the engine's write head goes all the way round it. Build with
+// -DMEMORY_REPORT to have the layout printed at boot.
+enum RingsMemory {
+  MEMORY_REVERB,
+  MEMORY_PLATE,
+  MEMORY_APDEMO,
+  RINGS_MEMORY_LAST
+};
+const int kEngineGroup = 1;
+constexpr size_t kRingBytes = sizeof(StorageArray<kReverbFormat>);
+constexpr MemoryNeed kMemoryNeeds[RINGS_MEMORY_LAST] = {
+    {"rings reverb", clevelandmusicco::MEMORY_SRAM, kRingBytes, kEngineGroup},
+    {"plate", clevelandmusicco::MEMORY_SRAM, kRingBytes, kEngineGroup},
+    {"all-pass demo", clevelandmusicco::MEMORY_SRAM, kRingBytes, kEngineGroup},
+};
+constexpr MemoryPlan<RINGS_MEMORY_LAST> kMemoryPlan(kMemoryNeeds);
+static_assert(kMemoryPlan.Fits(), "Mutable Rings' memory plan doesn't fit");
+alignas(MemoryPlan<RINGS_MEMORY_LAST>::kAlignment) uint8_t
+    sram_pool[kMemoryPlan.Footprint(clevelandmusicco::MEMORY_SRAM)];
+
+StorageBuffer<kReverbFormat> EngineBuffer(RingsMemory engine) {
+  using Storage = DataType<kReverbFormat>::T;
+  return StorageBuffer<kReverbFormat>(
+      kMemoryPlan.At<Storage>(sram_pool, engine),
+      StorageLength<kReverbFormat>(kDelayBufferLength));
+}
+
+MutableRings<kReverbFormat> reverb_(EngineBuffer(MEMORY_REVERB));
+DatorroPlate<kReverbFormat> plate_(EngineBuffer(MEMORY_PLATE));
+AllPassDemo<kReverbFormat> apdemo_(EngineBuffer(MEMORY_APDEMO));
+
+// How much CPU the reverbs spend on sounding their best (see
+// FxEngineBase::Quality). The all-pass demo is a single allpass either way.
+const FxEngineBase::Quality kReverbQuality = FxEngineBase::QUALITY_HIGH;
 
 Parameter p_knob_1, p_knob_2, p_knob_3, p_knob_4, p_knob_5, p_knob_6;
 
@@ -56,9 +101,43 @@ Led led_100p_wet, led_verb;
 bool bypass_100p_wet = true;
 bool bypass_verb = true;
 
-// void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
-//                   size_t size) {
-void AudioCallback(AudioHandle::InterleavingInputBuffer in, AudioHandle::InterleavingOutputBuffer out,
+// Turning the reverb off, or switching to another type, fades the wet signal
+// out. The engines share their buffer, so before a different one starts
+// the buffer is cleared, a piece per callback, or it would play the last
+// one's tail through its own delays. With kKillTailOnBypass the same happens
+// when the reverb is turned off.
+enum VerbState { VERB_OFF, VERB_ON, VERB_FADING_OUT, VERB_CLEARING };
+VerbState verb_state = VERB_OFF;
+const bool kKillTailOnBypass = true;
+const float kWetFadeSeconds = 0.01f;
+// Samples of the engines' buffer cleared per sample of the callback: four
+// cache lines of floats, so the 128 KB buffer takes about 20 ms.
+const size_t kClearPerSample = 32;
+int active_effect = 0;
+int clearing_effect = 0;
+float wet_level = 0.0f;
+
+void StartClear(int effect) {
+  switch (effect) {
+    case 0: reverb_.StartClear(); break;
+    case 1: plate_.StartClear(); break;
+    case 2: apdemo_.StartClear(); break;
+  }
+}
+
+bool ClearSome(int effect, size_t length) {
+  switch (effect) {
+    case 0: return reverb_.ClearSome(length);
+    case 1: return plate_.ClearSome(length);
+    case 2: return apdemo_.ClearSome(length);
+  }
+  return true;
+}
+
+// The engines read the input buffers and write the mix straight into the
+// output ones (see StereoView), so the audio is never copied or interleaved
+// on the way.
+void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
                    size_t blocksize) {
   hw.ProcessAllControls();
 
@@ -81,33 +160,79 @@ void AudioCallback(AudioHandle::InterleavingInputBuffer in, AudioHandle::Interle
   const float size = p_knob_2.Process();
   const float shape = p_knob_3.Process();
 
-  std::copy_n(in, blocksize, out);
+  static const int effect_type_values[] = {0, 1, 2};
+  const int effect_type = effect_type_values[hw.GetToggleswitchPosition(Hothouse::TOGGLESWITCH_1)];
 
-  if (!bypass_verb) {
-    // std::fill_n(out, blocksize, 0.0f);
-    StereoSignal in_stereo{reinterpret_cast<const StereoSample*>(in), blocksize / 2};
-    StereoBuffer out_stereo{reinterpret_cast<StereoSample*>(out), blocksize / 2};
+  switch (verb_state) {
+    case VERB_ON:
+      if (bypass_verb || effect_type != active_effect) {
+        verb_state = VERB_FADING_OUT;
+      }
+      break;
+    case VERB_FADING_OUT:
+      if (!bypass_verb && effect_type == active_effect) {
+        verb_state = VERB_ON;
+      } else if (wet_level == 0.0f) {
+        if (effect_type != active_effect || kKillTailOnBypass) {
+          clearing_effect = effect_type;
+          StartClear(clearing_effect);
+          verb_state = VERB_CLEARING;
+        } else {
+          verb_state = VERB_OFF;
+        }
+      }
+      break;
+    case VERB_CLEARING:
+      if (ClearSome(clearing_effect, blocksize * kClearPerSample)) {
+        active_effect = clearing_effect;
+        verb_state = VERB_OFF;
+      }
+      break;
+    case VERB_OFF:
+      if (!bypass_verb) {
+        if (effect_type == active_effect) {
+          verb_state = VERB_ON;
+        } else {
+          clearing_effect = effect_type;
+          StartClear(clearing_effect);
+          verb_state = VERB_CLEARING;
+        }
+      }
+      break;
+  }
+
+  // Block by block, which is how often the amount changes anyway
+  const float fade_step = blocksize / (kWetFadeSeconds * hw.AudioSampleRate());
+  if (verb_state == VERB_ON) {
+    wet_level = std::min(wet_level + fade_step, 1.0f);
+  } else if (verb_state == VERB_FADING_OUT) {
+    wet_level = std::max(wet_level - fade_step, 0.0f);
+  }
 
-    static const int effect_type_values[] = {0, 1, 2};
-    int effect_type = effect_type_values[hw.GetToggleswitchPosition(Hothouse::TOGGLESWITCH_1)];
+  if (verb_state != VERB_ON && verb_state != VERB_FADING_OUT) {
+    std::copy_n(in[0], blocksize, out[0]);
+    std::copy_n(in[1], blocksize, out[1]);
+  } else {
+    const StereoIn in_stereo = StereoIn::Planar(in[0], in[1], blocksize);
+    const StereoOut out_stereo = StereoOut::Planar(out[0], out[1], blocksize);
 
-    switch(effect_type) {
+    switch(active_effect) {
       case 0:
-        reverb_.set_amount(strength * 0.5f);
+        reverb_.set_amount(strength * 0.5f * wet_level);
         reverb_.set_time(0.35f + 0.63f * size);
         reverb_.set_input_gain(0.2f);
         reverb_.set_lp(0.3f + shape * 0.6f);
         reverb_.Process(in_stereo, out_stereo);
         break;
       case 1:
-        plate_.set_amount(strength * 0.5f);
+        plate_.set_amount(strength * 0.5f * wet_level);
         plate_.set_time(0.35f + 0.65f * size);
         plate_.set_input_gain(0.2f);
         plate_.set_lp(0.3f + shape * 0.7f);
         plate_.Process(in_stereo, out_stereo);
         break;
       case 2:
-        apdemo_.set_amount(strength);
+        apdemo_.set_amount(strength * wet_level);
         apdemo_.set_input_gain(0.2f);
         apdemo_.set_size(size);
         apdemo_.set_diffusion(shape);
@@ -133,11 +258,16 @@ int main() {
   p_knob_5.Init(hw.knobs[Hothouse::KNOB_5], 0.0f, 1.0f, Parameter::LINEAR);
   p_knob_6.Init(hw.knobs[Hothouse::KNOB_6], 0.0f, 1.0f, Parameter::LINEAR);
 
-  delay_line_buffer.fill(0);
+#ifdef MEMORY_REPORT
+  hw.seed.StartLog();
+  kMemoryPlan.Report([](const char* line) { hw.seed.PrintLine("%s", line); });
+#endif
 
   reverb_.Init(hw.AudioSampleRate());
   plate_.Init(hw.AudioSampleRate());
   apdemo_.Init(hw.AudioSampleRate());
+  reverb_.set_quality(kReverbQuality);
+  plate_.set_quality(kReverbQuality);
  
   hw.StartAdc();
   hw.StartAudio(AudioCallback);
@@ -22,6 +22,9 @@
 #include "daisysp.h"
 #include "hothouse.h"
 #include "Dattorro.hpp"
+#include "DattorroBypass.hpp"
+#include "DattorroParameters.hpp"
+#include "ReducedRateDattorro.hpp"
 
 using clevelandmusicco::Hothouse;
 using daisy::AudioHandle;
@@ -32,8 +35,21 @@ using daisy::System;
 
 Hothouse hw;
 
-// Dattorro verb(32000, 16, 4.0);
-Dattorro verb(48000, 16, 4.0);
+// The plate (input diffusion and tank) runs at this rate, resampled to and
+// from the 48 kHz audio. 32000 saves about a third of its cycles and delay
+// memory and keeps everything up to about 11 kHz; 24000 saves half and keeps
+// up to about 8 kHz. 48000 runs it at the audio rate.
+const float kPlateSampleRate = 32000;
+
+// How much of its CPU the plate spends on sounding its best (see
+// Dattorro::setQuality()).
+const ReverbQuality kPlateQuality = QUALITY_HIGH;
+
+Dattorro verb(kPlateSampleRate, 16, 4.0);
+ReducedRateDattorro verbWet(verb);
+// The knobs go through here so that only the parameters that moved are
+// recomputed.
+DattorroParameters verbParams(verb);
 
 bool plateDiffusionEnabled = true;
 float platePreDelay = 0.;
@@ -71,6 +87,16 @@ float plateTankModSpeed = 1.0;
 float plateTankModDepth = 0.5;
 float plateTankModShape = 0.75;
 
+// Most samples the plate is handed at once. Blocks bigger than this are
+// split up.
+const size_t kVerbChunk = 32;
+
+// Fades the plate in and out. Turning it off also clears it, a piece per
+// callback, so that it comes back without the old tail. That includes what
+// the resamplers around it still hold.
+DattorroBypass verbBypass(verb, &verbWet);
+const bool kKillVerbTailOnBypass = true;
+
 const float minus18dBGain = 0.12589254;
 const float minus20dBGain = 0.1;
 
@@ -142,29 +168,45 @@ void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out,
   static const float pre_delay_values[] = {0.1f, 0.05f, 0.0f};
   platePreDelay = pre_delay_values[hw.GetToggleswitchPosition(Hothouse::TOGGLESWITCH_3)];
 
-  if (!bypass_verb) {
-    // verb.setDecay(plateDecay);
-    // verb.setTankDiffusion(plateTankDiffusion);
-    // verb.setInputFilterHighCutoffPitch(plateInputDampHigh);
-    // verb.setTankFilterHighCutFrequency(plateTankDampHigh);
-
-    // verb.setTankModSpeed(plateTankModSpeed);
-    // verb.setTankModDepth(plateTankModDepth);
-    // verb.setPreDelay(platePreDelay);    
+  // Until its memory has been cleared (see main()) the plate sits out, as if
+  // it were bypassed, and then fades in.
+  const bool verb_ready = delayPlacement.isCleared();
+  if (verbBypass.update(!bypass_verb && verb_ready, size)) {
+    verbParams.set(DattorroParameters::DECAY, plateDecay);
+    verbParams.set(DattorroParameters::TANK_DIFFUSION, plateTankDiffusion);
+    verbParams.set(DattorroParameters::INPUT_HIGH_CUT_PITCH, plateInputDampHigh);
+    verbParams.set(DattorroParameters::TANK_HIGH_CUT_PITCH, plateTankDampHigh);
+
+    verbParams.set(DattorroParameters::TANK_MOD_SPEED, plateTankModSpeed);
+    verbParams.set(DattorroParameters::TANK_MOD_DEPTH, plateTankModDepth);
+    verbParams.set(DattorroParameters::PRE_DELAY, platePreDelay);
+    verbParams.apply();
+
+    const float inputGain = minus18dBGain * minus20dBGain * (1.0 + inputAmplification * 7.);
+
+    // The plate runs a chunk at a time, in place in these buffers
+    float verbLeft[kVerbChunk];
+    float verbRight[kVerbChunk];
+    for (size_t start = 0; start < size; start += kVerbChunk) {
+      const size_t n = size - start < kVerbChunk ? size - start : kVerbChunk;
+      for (size_t i = 0; i < n; ++i) {
+        // Dattorro seems to want to have values between -10 and 10 so times by 10
+        verbLeft[i] = hardLimit100_(in[0][start + i]) * 10. * inputGain;
+        verbRight[i] = hardLimit100_(in[1][start + i]) * 10. * inputGain;
+      }
 
-    for (size_t i = 0; i < size; ++i) {
-      // Dattorro seems to want to have values between -10 and 10 so times by 10
-      leftInput = hardLimit100_(in[0][i]) * 10.;
-      rightInput = hardLimit100_(in[1][i]) * 10.;
+      verbWet.process(verbLeft, verbRight, verbLeft, verbRight, n);
 
-      verb.process(leftInput * minus18dBGain * minus20dBGain * (1.0 + inputAmplification * 7.) * clearPopCancelValue,
-                    rightInput * minus18dBGain * minus20dBGain * (1.0 + inputAmplification * 7.) * clearPopCancelValue);
+      for (size_t i = 0; i < n; ++i) {
+        leftInput = hardLimit100_(in[0][start + i]) * 10.;
+        rightInput = hardLimit100_(in[1][start + i]) * 10.;
 
-      leftOutput = ((leftInput * plateDry * 0.1) + (verb.getLeftOutput() * plateWet * clearPopCancelValue));
-      rightOutput = ((rightInput * plateDry * 0.1) + (verb.getRightOutput() * plateWet * clearPopCancelValue));
+        leftOutput = ((leftInput * plateDry * 0.1) + (verbLeft[i] * plateWet));
+        rightOutput = ((rightInput * plateDry * 0.1) + (verbRight[i] * plateWet));
 
-      out[0][i] = leftOutput;
-      out[1][i] = rightOutput;
+        out[0][start + i] = leftOutput;
+        out[1][start + i] = rightOutput;
+      }
     }
   } else {
     for (size_t i = 0; i < size; ++i) {
@@ -192,25 +234,22 @@ int main() {
   p_knob_5.Init(hw.knobs[Hothouse::KNOB_5], 0.0f, 1.0f, Parameter::LINEAR);
   p_knob_6.Init(hw.knobs[Hothouse::KNOB_6], 0.0f, 1.0f, Parameter::LINEAR);
 
-  // Zero out the InterpDelay buffers used by the plate reverb
-  for(int i = 0; i < 50; i++) {
-      for(int j = 0; j < 144000; j++) {
-          sdramData[i][j] = 0.;
-      }
-  }
-
-  // Set this to 1.0 or plate reverb won't work. This is defined in Dattorro's
-  // InterpDelay.cpp file.
-  hold = 1.;
+  // Move the plate's busiest delays into on-chip memory. Their memory is
+  // zeroed once the audio is running.
+  delayPlacement.place();
 
   // Reverb Defaults
-  verb.setSampleRate(48000);
-  // verb.setSampleRate(32000);
+  verbWet.setSampleRates(48000, kPlateSampleRate);
   verb.setTimeScale(plateTimeScale);
+  // The time scale is fixed, so the tank's delays can be rounded to whole
+  // samples. Without modulation the plate then runs without interpolating.
+  verb.setWholeSampleDelays(true);
+  verb.setQuality(kPlateQuality);
   verb.setPreDelay(platePreDelay);
   verb.setInputFilterLowCutoffPitch(0.0);
   verb.setInputFilterHighCutoffPitch(10000.0);
   verb.enableInputDiffusion(plateDiffusionEnabled);
+  verbBypass.setKillTail(kKillVerbTailOnBypass);
   verb.setDecay(plateDecay);
   verb.setTankDiffusion(plateTankDiffusion);
   verb.setTankFilterLowCutFrequency(0);
@@ -222,6 +261,11 @@ int main() {
   hw.StartAdc();
   hw.StartAudio(AudioCallback);
 
+  // SDRAM isn't cleared at boot. Zero the plate's memory with the audio
+  // already passing dry rather than keeping the pedal silent until it's done.
+  while (!delayPlacement.clearSome()) {
+  }
+
   while (true) {
     hw.DelayMs(10);
 
@@ -0,0 +1,201 @@
+/*
+ * Signal analysis for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace host {
+
+namespace {
+
+constexpr size_t kFftSize = 4096;
+constexpr double kLowestBandHz = 25.;
+
+// Keeps silent bands finite in dB.
+constexpr double kPowerFloor = 1e-30;
+
+// Average power per FFT bin. Signals shorter than one FFT are zero padded.
+std::vector<double> AveragePowerSpectrum(const float *samples, size_t frames) {
+  std::vector<double> window(kFftSize);
+  for (size_t i = 0; i < kFftSize; i++) {
+    window[i] = 0.5 - 0.5 * cos(2. * M_PI * i / kFftSize);
+  }
+  std::vector<double> power(kFftSize / 2 + 1, 0.);
+  std::vector<std::complex<double>> bins(kFftSize);
+  size_t windows = 0;
+  for (size_t start = 0; windows == 0 || start + kFftSize <= frames;
+       start += kFftSize / 2) {
+    for (size_t i = 0; i < kFftSize; i++) {
+      const double x = start + i < frames ? samples[start + i] : 0.;
+      bins[i] = x * window[i];
+    }
+    Fft(&bins);
+    for (size_t i = 0; i < power.size(); i++) {
+      power[i] += std::norm(bins[i]);
+    }
+    windows++;
+  }
+  for (double &p : power) {
+    p /= windows;
+  }
+  return power;
+}
+
+}  // namespace
+
+void Fft(std::vector<std::complex<double>> *data) {
+  std::vector<std::complex<double>> &x = *data;
+  const size_t n = x.size();
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(x[i], x[j]);
+    }
+  }
+  for (size_t len = 2; len <= n; len <<= 1) {
+    const double angle = -2. * M_PI / static_cast<double>(len);
+    const std::complex<double> step(cos(angle), sin(angle));
+    for (size_t i = 0; i < n; i += len) {
+      std::complex<double> w(1.);
+      for (size_t k = 0; k < len / 2; k++) {
+        const std::complex<double> even = x[i + k];
+        const std::complex<double> odd = x[i + k + len / 2] * w;
+        x[i + k] = even + odd;
+        x[i + k + len / 2] = even - odd;
+        w *= step;
+      }
+    }
+  }
+}
+
+BandSpectrum ThirdOctaveSpectrum(const float *samples, size_t frames,
+                                 float sample_rate) {
+  const std::vector<double> power = AveragePowerSpectrum(samples, frames);
+
+  BandSpectrum spectrum;
+  const double bin_hz = sample_rate / static_cast<double>(kFftSize);
+  const double nyquist = sample_rate / 2.;
+  for (double center = kLowestBandHz; center * pow(2., 1. / 6.) <= nyquist;
+       center *= pow(2., 1. / 3.)) {
+    const double low = center * pow(2., -1. / 6.);
+    const double high = center * pow(2., 1. / 6.);
+    double sum = 0.;
+    for (size_t i = static_cast<size_t>(ceil(low / bin_hz));
+         i < power.size() && i * bin_hz < high; i++) {
+      sum += power[i];
+    }
+    spectrum.centers_hz.push_back(center);
+    spectrum.level_db.push_back(10. * log10(std::max(sum, kPowerFloor)));
+  }
+  return spectrum;
+}
+
+double SpectralDeviationDb(const BandSpectrum &reference,
+                           const BandSpectrum &actual, double range_db) {
+  if (reference.level_db.empty()) {
+    return 0.;
+  }
+  const double loudest = *std::max_element(reference.level_db.begin(),
+                                           reference.level_db.end());
+  double deviation = 0.;
+  const size_t bands =
+      std::min(reference.level_db.size(), actual.level_db.size());
+  for (size_t i = 0; i < bands; i++) {
+    if (reference.level_db[i] < loudest - range_db) {
+      continue;
+    }
+    deviation = std::max(
+        deviation, std::abs(actual.level_db[i] - reference.level_db[i]));
+  }
+  return deviation;
+}
+
+double Rt60Seconds(const float *samples, size_t frames, float sample_rate) {
+  // Energy still to come after each sample, in dB below the total.
+  std::vector<double> decay(frames);
+  double remaining = 0.;
+  for (size_t i = frames; i-- > 0;) {
+    remaining += static_cast<double>(samples[i]) * samples[i];
+    decay[i] = remaining;
+  }
+  if (frames == 0 || remaining <= 0.) {
+    return std::numeric_limits<double>::infinity();
+  }
+  const double total = remaining;
+  for (double &d : decay) {
+    d = 10. * log10(std::max(d / total, kPowerFloor));
+  }
+
+  // Least-squares line through the part of the curve from -5 to -25 dB.
+  double n = 0., sum_t = 0., sum_db = 0., sum_tt = 0., sum_tdb = 0.;
+  bool reached = false;
+  for (size_t i = 0; i < frames; i++) {
+    if (decay[i] > -5.) {
+      continue;
+    }
+    if (decay[i] < -25.) {
+      reached = true;
+      break;
+    }
+    const double t = i / static_cast<double>(sample_rate);
+    n += 1.;
+    sum_t += t;
+    sum_db += decay[i];
+    sum_tt += t * t;
+    sum_tdb += t * decay[i];
+  }
+  const double denominator = n * sum_tt - sum_t * sum_t;
+  if (!reached || n < 2. || denominator <= 0.) {
+    return std::numeric_limits<double>::infinity();
+  }
+  const double slope = (n * sum_tdb - sum_t * sum_db) / denominator;
+  return slope < 0. ? -60. / slope : std::numeric_limits<double>::infinity();
+}
+
+double SpectralCentroidHz(const float *samples, size_t frames,
+                          float sample_rate) {
+  const std::vector<double> power = AveragePowerSpectrum(samples, frames);
+  const double bin_hz = sample_rate / static_cast<double>(kFftSize);
+  double weighted = 0.;
+  double sum = 0.;
+  for (size_t i = 0; i < power.size(); i++) {
+    weighted += i * bin_hz * power[i];
+    sum += power[i];
+  }
+  return sum > 0. ? weighted / sum : 0.;
+}
+
+double PeakDb(const float *samples, size_t frames) {
+  float peak = 0.f;
+  for (size_t i = 0; i < frames; i++) {
+    peak = std::max(peak, std::abs(samples[i]));
+  }
+  return 20. * log10(std::max(static_cast<double>(peak), 1e-15));
+}
+
+}  // namespace host
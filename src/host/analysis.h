@@ -0,0 +1,72 @@
+/*
+ * Signal analysis for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_ANALYSIS_H
+#define HOST_ANALYSIS_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace host {
+
+/// @brief In-place radix-2 FFT. The size must be a power of two.
+void Fft(std::vector<std::complex<double>> *data);
+
+/// @brief Long-term spectrum of a signal in third-octave bands.
+struct BandSpectrum {
+  std::vector<double> centers_hz;
+  std::vector<double> level_db;  ///< Mean power in each band, in dB
+};
+
+/// @brief Averages the power spectrum over the whole signal (Hann windows
+/// with 50% overlap) and sums it into third-octave bands from 25 Hz up to
+/// Nyquist.
+BandSpectrum ThirdOctaveSpectrum(const float *samples, size_t frames,
+                                 float sample_rate);
+
+/// @brief Largest level difference between two spectra, in dB.
+///
+/// Bands more than `range_db` below the loudest band of the reference are
+/// left out. Their levels are mostly numerical noise, and a tiny absolute
+/// difference there can be a big difference in dB.
+double SpectralDeviationDb(const BandSpectrum &reference,
+                           const BandSpectrum &actual, double range_db = 60.);
+
+/// @brief Reverb time from the Schroeder backward integral of a decay,
+/// extrapolated to 60 dB from a straight-line fit between -5 and -25 dB (T20).
+///
+/// Returns infinity when the decay never gets 25 dB down, as with a frozen
+/// tank or a render that is too short for its decay.
+double Rt60Seconds(const float *samples, size_t frames, float sample_rate);
+
+/// @brief Power-weighted mean frequency of the averaged spectrum, in Hz.
+/// Zero for silence.
+double SpectralCentroidHz(const float *samples, size_t frames,
+                          float sample_rate);
+
+/// @brief Largest absolute sample, in dBFS.
+double PeakDb(const float *samples, size_t frames);
+
+}  // namespace host
+
+#endif  // HOST_ANALYSIS_H
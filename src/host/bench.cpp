@@ -0,0 +1,631 @@
+/*
+ * CPU budget benchmark for Hothouse DSP Platform effects
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// Runs every engine through the same input and control automation at a range
+// of block sizes, and at each of its CPU/quality tiers, and reports what each
+// one costs as a share of the 48 kHz budget on the pedal. The results are
+// JSON with one result per line, so two runs can be compared with diff or
+// with --baseline.
+//
+// Each case runs in a forked child (see RunForked()), so every case starts
+// from a clean slate.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "dsp/delays/DelayArena.hpp"
+#include "dsp/delays/DelayPlacement.hpp"
+#include "engines.h"
+#include "forked.h"
+#include "host_runtime.h"
+#include "sai_timing.h"
+
+using host::AutomatedKnob;
+using host::Engine;
+using host::EngineQuality;
+using host::Runtime;
+using host::SaiTimingModel;
+
+/// Flick's main(), renamed by the Makefile.
+int hothouse_effect_main();
+
+namespace {
+
+constexpr float kSampleRate = 48000.f;
+constexpr double kTargetMhz = 480.;  // Daisy Seed (STM32H750) at full speed
+constexpr size_t kNumKnobs = Runtime::kNumKnobs;
+constexpr size_t kDefaultBlockSizes[] = {1, 8, 32, 48, 128};
+
+// Knobs are moved this often, which is a lot more often than anyone turns a
+// knob but makes sure parameter changes are part of the measurement.
+constexpr double kAutomationStepSeconds = 0.01;
+
+struct Options {
+  double seconds = 10.;
+  double warmup_seconds = 2.;
+  double cpu_ratio = 0.;  // 0 means work it out from the host clock
+  double max_regression_pct = 0.;
+  bool placement = false;
+  std::vector<std::string> engines;
+  std::vector<size_t> block_sizes;
+  std::vector<EngineQuality> qualities;
+  const char *output_path = nullptr;
+  const char *baseline_path = nullptr;
+};
+
+/// What a child sends back to the parent, so it has to stay trivially
+/// copyable.
+struct CaseResult {
+  bool ok;
+  double ns_per_sample;
+  double worst_block_ns;
+  double budget_pct;
+  double worst_block_pct;
+  uint64_t missed_deadlines;
+  uint64_t memory_bytes;
+  uint64_t io_bytes_per_block;  ///< 0 if not known (Flick)
+  double delay_bytes_per_sample;  ///< 0 if not known
+};
+
+//
+// Input and control automation
+//
+
+/// @brief A repeatable guitar-ish test signal: a plucked note every half
+/// second, alternating between two pitches, with a bit of noise in the
+/// attack.
+class TestSignal : public host::AudioSource {
+ public:
+  explicit TestSignal(double seconds)
+      : frames_(static_cast<size_t>(seconds * kSampleRate)) {}
+
+  size_t Read(float *left, float *right, size_t frames) override {
+    const size_t n = std::min(frames, frames_ - position_);
+    for (size_t i = 0; i < n; i++) {
+      Next(&left[i], &right[i]);
+    }
+    return n;
+  }
+
+  float SampleRate() const override { return kSampleRate; }
+
+  void Next(float *left, float *right) {
+    const size_t note_frames = static_cast<size_t>(kSampleRate / 2);
+    const size_t t = position_ % note_frames;
+    const size_t note = position_ / note_frames;
+    if (t == 0) {
+      phase_ = 0.f;
+      increment_ = (note & 1 ? 196.f : 110.f) / kSampleRate;
+    }
+    const float envelope = expf(-6.f * t / note_frames);
+    const float noise = (Random() - 0.5f) * expf(-200.f * t / note_frames);
+    const float tone = sinf(2.f * static_cast<float>(M_PI) * phase_);
+    phase_ += increment_;
+    if (phase_ >= 1.f) {
+      phase_ -= 1.f;
+    }
+    *left = 0.5f * envelope * tone + 0.3f * noise;
+    *right = 0.5f * envelope * tone - 0.3f * noise;
+    position_++;
+  }
+
+ private:
+  float Random() {
+    seed_ = seed_ * 1664525u + 1013904223u;
+    return static_cast<float>(seed_ >> 8) / 16777216.f;
+  }
+
+  size_t frames_;
+  size_t position_ = 0;
+  uint32_t seed_ = 1;
+  float phase_ = 0.f;
+  float increment_ = 0.f;
+};
+
+void RunEngine(Engine &engine, size_t block_size, const Options &options,
+               SaiTimingModel *timing) {
+  using Clock = std::chrono::steady_clock;
+  const size_t warmup_frames =
+      static_cast<size_t>(options.warmup_seconds * kSampleRate);
+  const size_t total_frames =
+      warmup_frames + static_cast<size_t>(options.seconds * kSampleRate);
+  const double period_us = block_size * 1e6 / kSampleRate;
+
+  TestSignal signal(options.warmup_seconds + options.seconds);
+  std::vector<float> in_left(block_size), in_right(block_size);
+  std::vector<float> out_left(block_size), out_right(block_size);
+  float knobs[kNumKnobs];
+  double next_automation = 0.;
+  bool warm = false;
+
+  for (size_t frame = 0; frame + block_size <= total_frames;
+       frame += block_size) {
+    const double seconds = frame / static_cast<double>(kSampleRate);
+    if (!warm && frame >= warmup_frames) {
+      timing->Reset();
+      warm = true;
+    }
+    if (seconds >= next_automation) {
+      for (size_t k = 0; k < kNumKnobs; k++) {
+        knobs[k] = AutomatedKnob(k, seconds);
+      }
+      next_automation += kAutomationStepSeconds;
+    }
+    signal.Read(in_left.data(), in_right.data(), block_size);
+
+    const Clock::time_point start = Clock::now();
+    engine.Automate(knobs);
+    engine.Process(in_left.data(), in_right.data(), out_left.data(),
+                   out_right.data(), block_size);
+    const Clock::time_point end = Clock::now();
+    timing->Record(static_cast<uint64_t>(seconds * 1e6), period_us,
+                   std::chrono::duration<double, std::nano>(end - start)
+                       .count());
+  }
+}
+
+/// @brief Runs the whole Flick firmware (delay, tremolo and reverb all on)
+/// through the host runtime, so the cost includes its control handling.
+void RunFlick(size_t block_size, const Options &options,
+              SaiTimingModel *timing) {
+  Runtime &rt = Runtime::Get();
+  TestSignal signal(options.warmup_seconds + options.seconds);
+  rt.SetSource(&signal);
+  rt.SetBlockSizeOverride(block_size);
+  rt.Timing().SetCpuRatio(timing->CpuRatio());
+
+  // FS1 turns the reverb on. A double press of FS2 turns the tremolo on (the
+  // first press of it toggles the delay, and the double press undoes that),
+  // then one more press turns the delay on.
+  const double presses[][2] = {{0, 0.5}, {1, 0.5}, {1, 0.8}, {1, 1.6}};
+  for (const auto &press : presses) {
+    const size_t footswitch = static_cast<size_t>(press[0]);
+    rt.At(press[1], [&rt, footswitch] { rt.SetFootswitch(footswitch, true); });
+    rt.At(press[1] + 0.1,
+          [&rt, footswitch] { rt.SetFootswitch(footswitch, false); });
+  }
+  const double end = options.warmup_seconds + options.seconds;
+  for (double t = 0.; t < end; t += kAutomationStepSeconds) {
+    rt.At(t, [&rt, t] {
+      for (size_t k = 0; k < kNumKnobs; k++) {
+        rt.SetKnob(k, AutomatedKnob(k, t));
+      }
+    });
+  }
+  rt.At(options.warmup_seconds, [&rt] { rt.Timing().Reset(); });
+
+  try {
+    hothouse_effect_main();
+  } catch (const host::RenderFinished &finished) {
+    if (!finished.complete) {
+      fprintf(stderr, "flick: %s\n", finished.reason);
+    }
+  }
+  *timing = rt.Timing();
+}
+
+/// @brief Every case the benchmark knows: the engines on their own, then the
+/// whole Flick firmware.
+const std::vector<std::string> &EngineCases() {
+  static const std::vector<std::string> cases = [] {
+    std::vector<std::string> names = host::EngineNames();
+    names.push_back("flick");
+    return names;
+  }();
+  return cases;
+}
+
+//
+// Running the cases
+//
+
+/// @brief The tiers to run `engine` at, or a single nullopt if it has none.
+std::vector<std::optional<EngineQuality>> CaseQualities(
+    const std::string &engine, const Options &options) {
+  if (!host::EngineHasQualities(engine)) {
+    return {std::nullopt};
+  }
+  if (!options.qualities.empty()) {
+    return {options.qualities.begin(), options.qualities.end()};
+  }
+  return {EngineQuality::kLow, EngineQuality::kMedium, EngineQuality::kHigh};
+}
+
+/// @brief How a tier shows up in the results. Engines without tiers (and
+/// Flick, whose plate picks its own) are "fixed".
+const char *CaseQualityName(std::optional<EngineQuality> quality) {
+  return quality ? host::QualityName(*quality) : "fixed";
+}
+
+CaseResult RunCase(const std::string &engine,
+                   std::optional<EngineQuality> quality, size_t block_size,
+                   const Options &options) {
+  CaseResult result = {};
+  const auto run = [&engine, quality, block_size, &options] {
+    SaiTimingModel timing;
+    timing.SetCpuRatio(options.cpu_ratio);
+    uint64_t memory_bytes = 0;
+    uint64_t io_bytes_per_block = 0;
+    double delay_bytes_per_sample = 0.;
+    if (engine == "flick") {
+      RunFlick(block_size, options, &timing);
+      memory_bytes = delayArena.bytesUsed();
+    } else {
+      // Leave the fast memory to the engine rather than to Flick's plate.
+      delayPlacement.forget();
+      std::unique_ptr<Engine> standalone = host::MakeEngine(engine);
+      if (quality) {
+        standalone->SetQuality(*quality);
+      }
+      RunEngine(*standalone, block_size, options, &timing);
+      memory_bytes = standalone->MemoryBytes();
+      io_bytes_per_block = standalone->IoBytesPerFrame() * block_size;
+      delay_bytes_per_sample = standalone->DelayBytesPerSample();
+    }
+    const double frames =
+        static_cast<double>(timing.Callbacks()) * static_cast<double>(block_size);
+    CaseResult r = {};
+    r.ok = timing.Callbacks() > 0;
+    r.ns_per_sample = frames > 0 ? timing.TotalHostNs() / frames : 0.;
+    r.worst_block_ns = timing.WorstHostNs();
+    r.budget_pct = timing.AverageLoad() * 100.;
+    r.worst_block_pct = timing.PeakLoad() * 100.;
+    r.missed_deadlines = timing.MissedDeadlines();
+    r.memory_bytes = memory_bytes;
+    r.io_bytes_per_block = io_bytes_per_block;
+    r.delay_bytes_per_sample = delay_bytes_per_sample;
+    return r;
+  };
+  if (!host::RunForked(run, &result)) {
+    result.ok = false;
+  }
+  return result;
+}
+
+/// Where a case's delays ended up, sent back from a child.
+struct PlacementResult {
+  bool ok;
+  size_t delays;
+  char report[4096];
+};
+
+/// @brief Builds the case's engine and places its delays the way the firmware
+/// does at boot, without running it.
+PlacementResult PlaceCase(const std::string &engine) {
+  PlacementResult result = {};
+  const auto run = [&engine] {
+    std::unique_ptr<Engine> standalone;
+    if (engine == "flick") {
+      // Flick's plate is a global, so it has been built already.
+      delayPlacement.place();
+    } else {
+      delayPlacement.forget();  // Flick's plate, which isn't running
+      standalone = host::MakeEngine(engine);
+    }
+    PlacementResult r = {};
+    r.ok = true;
+    r.delays = delayPlacement.delayCount();
+    delayPlacement.report(r.report, sizeof(r.report));
+    return r;
+  };
+  if (!host::RunForked(run, &result)) {
+    result.ok = false;
+  }
+  return result;
+}
+
+/// @brief Guesses the host clock in MHz, preferring the maximum (boost) clock
+/// since that is what a benchmark ends up running at.
+double HostMhz() {
+  std::ifstream max_freq("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+  double khz = 0.;
+  if (max_freq >> khz && khz > 0.) {
+    return khz / 1000.;
+  }
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    double mhz = 0.;
+    if (line.rfind("cpu MHz", 0) == 0 &&
+        sscanf(line.c_str() + line.find(':') + 1, "%lf", &mhz) == 1) {
+      return mhz;
+    }
+  }
+  return 0.;
+}
+
+/// What a case measured in an earlier run.
+struct BaselineCase {
+  double ns_per_sample = 0.;
+  uint64_t io_bytes_per_block = 0;  ///< 0 if the run didn't say
+};
+
+/// Baseline results keyed by BaselineKey().
+using Baseline = std::map<std::string, BaselineCase>;
+
+std::string BaselineKey(const std::string &engine, const char *quality,
+                        size_t block) {
+  return engine + "/" + quality + "/" + std::to_string(block);
+}
+
+bool LoadBaseline(const char *path, Baseline *baseline) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    char engine[64];
+    char quality[16];
+    size_t block = 0;
+    BaselineCase result;
+    // Runs from before it was reported don't have it.
+    const char *io = strstr(line.c_str(), "\"io_bytes_per_block\": ");
+    unsigned long long io_bytes = 0;
+    if (io != nullptr &&
+        sscanf(io, "\"io_bytes_per_block\": %llu", &io_bytes) == 1) {
+      result.io_bytes_per_block = io_bytes;
+    }
+    if (sscanf(line.c_str(),
+               " {\"engine\": \"%63[^\"]\", \"quality\": \"%15[^\"]\", "
+               "\"block\": %zu, \"ns_per_sample\": %lf",
+               engine, quality, &block, &result.ns_per_sample) == 4) {
+      (*baseline)[BaselineKey(engine, quality, block)] = result;
+    } else if (sscanf(line.c_str(),
+                      " {\"engine\": \"%63[^\"]\", \"block\": %zu, "
+                      "\"ns_per_sample\": %lf",
+                      engine, &block, &result.ns_per_sample) == 3) {
+      // From before the tiers, when everything ran at what is now "high".
+      const bool tiers = host::EngineHasQualities(engine);
+      (*baseline)[BaselineKey(engine, tiers ? "high" : "fixed", block)] =
+          result;
+    }
+  }
+  return true;
+}
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "\n"
+          "options:\n"
+          "  --engine NAME         Only run this engine (repeatable)\n"
+          "  --block N             Only run this block size (repeatable)\n"
+          "  --quality TIER        Only run engines that have tiers at this "
+          "one: low,\n"
+          "                        medium or high (repeatable)\n"
+          "  --seconds S           Measure S seconds of audio per case "
+          "(default: 10)\n"
+          "  --warmup S            Run S seconds before measuring "
+          "(default: 2)\n"
+          "  --cpu-ratio R         How many times slower the pedal is than "
+          "this machine\n"
+          "                        (default: host MHz / %.0f)\n"
+          "  --output FILE         Write the JSON here instead of stdout\n"
+          "  --baseline FILE       Compare ns/sample against an earlier run\n"
+          "  --max-regression PCT  With --baseline, fail if any case got "
+          "more than\n"
+          "                        PCT percent slower\n"
+          "  --placement           Print which memory each case's delays "
+          "are placed in,\n"
+          "                        instead of timing it\n"
+          "\n"
+          "engines:",
+          prog, kTargetMhz);
+  for (const std::string &name : EngineCases()) {
+    fprintf(stderr, " %s", name.c_str());
+  }
+  fprintf(stderr, "\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--engine") == 0 && has_value) {
+      options.engines.push_back(argv[++i]);
+    } else if (strcmp(arg, "--block") == 0 && has_value) {
+      options.block_sizes.push_back(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--quality") == 0 && has_value) {
+      EngineQuality quality;
+      if (!host::ParseQuality(argv[++i], &quality)) {
+        fprintf(stderr, "unknown quality '%s'\n", argv[i]);
+        usage(argv[0]);
+        return 2;
+      }
+      options.qualities.push_back(quality);
+    } else if (strcmp(arg, "--seconds") == 0 && has_value) {
+      options.seconds = atof(argv[++i]);
+    } else if (strcmp(arg, "--warmup") == 0 && has_value) {
+      options.warmup_seconds = atof(argv[++i]);
+    } else if (strcmp(arg, "--cpu-ratio") == 0 && has_value) {
+      options.cpu_ratio = atof(argv[++i]);
+    } else if (strcmp(arg, "--output") == 0 && has_value) {
+      options.output_path = argv[++i];
+    } else if (strcmp(arg, "--baseline") == 0 && has_value) {
+      options.baseline_path = argv[++i];
+    } else if (strcmp(arg, "--max-regression") == 0 && has_value) {
+      options.max_regression_pct = atof(argv[++i]);
+    } else if (strcmp(arg, "--placement") == 0) {
+      options.placement = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.block_sizes.empty()) {
+    options.block_sizes.assign(std::begin(kDefaultBlockSizes),
+                               std::end(kDefaultBlockSizes));
+  }
+  for (const std::string &name : options.engines) {
+    if (std::find(EngineCases().begin(), EngineCases().end(), name) ==
+        EngineCases().end()) {
+      fprintf(stderr, "unknown engine '%s'\n", name.c_str());
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (options.placement) {
+    int status = 0;
+    for (const std::string &engine : EngineCases()) {
+      if (!options.engines.empty() &&
+          std::find(options.engines.begin(), options.engines.end(),
+                    engine) == options.engines.end()) {
+        continue;
+      }
+      const PlacementResult r = PlaceCase(engine);
+      if (!r.ok) {
+        fprintf(stderr, "%s failed\n", engine.c_str());
+        status = 1;
+      } else if (r.delays == 0) {
+        printf("%s: no placed delays\n", engine.c_str());
+      } else {
+        printf("%s:\n%s", engine.c_str(), r.report);
+      }
+    }
+    return status;
+  }
+
+  const double host_mhz = HostMhz();
+  if (options.cpu_ratio <= 0.) {
+    if (host_mhz <= 0.) {
+      fprintf(stderr, "can't tell the host clock speed, pass --cpu-ratio\n");
+      return 2;
+    }
+    options.cpu_ratio = host_mhz / kTargetMhz;
+  }
+
+  Baseline baseline;
+  if (options.baseline_path != nullptr &&
+      !LoadBaseline(options.baseline_path, &baseline)) {
+    fprintf(stderr, "can't read %s\n", options.baseline_path);
+    return 2;
+  }
+
+  FILE *out = stdout;
+  if (options.output_path != nullptr) {
+    out = fopen(options.output_path, "w");
+    if (out == nullptr) {
+      fprintf(stderr, "can't create %s\n", options.output_path);
+      return 2;
+    }
+  }
+
+  fprintf(out,
+          "{\n"
+          "  \"sample_rate\": %.0f,\n"
+          "  \"seconds\": %.1f,\n"
+          "  \"host_mhz\": %.0f,\n"
+          "  \"target_mhz\": %.0f,\n"
+          "  \"cpu_ratio\": %.3f,\n"
+          "  \"results\": [\n",
+          kSampleRate, options.seconds, host_mhz, kTargetMhz,
+          options.cpu_ratio);
+
+  int status = 0;
+  bool first = true;
+  for (const std::string &engine : EngineCases()) {
+    if (!options.engines.empty() &&
+        std::find(options.engines.begin(), options.engines.end(),
+                  engine) == options.engines.end()) {
+      continue;
+    }
+    for (std::optional<EngineQuality> quality :
+         CaseQualities(engine, options)) {
+      const char *quality_name = CaseQualityName(quality);
+      for (size_t block_size : options.block_sizes) {
+        const CaseResult r = RunCase(engine, quality, block_size, options);
+        if (!r.ok) {
+          fprintf(stderr, "%s (%s) at block size %zu failed\n",
+                  engine.c_str(), quality_name, block_size);
+          status = 1;
+          continue;
+        }
+        fprintf(out,
+                "%s    {\"engine\": \"%s\", \"quality\": \"%s\", "
+                "\"block\": %zu, \"ns_per_sample\": %.3f, "
+                "\"worst_block_ns\": %.0f, \"budget_pct\": %.2f, "
+                "\"worst_block_pct\": %.2f, \"missed_deadlines\": %llu, "
+                "\"memory_bytes\": %llu, \"io_bytes_per_block\": %llu, "
+                "\"delay_bytes_per_sample\": %.2f}",
+                first ? "" : ",\n", engine.c_str(), quality_name, block_size,
+                r.ns_per_sample, r.worst_block_ns, r.budget_pct,
+                r.worst_block_pct,
+                static_cast<unsigned long long>(r.missed_deadlines),
+                static_cast<unsigned long long>(r.memory_bytes),
+                static_cast<unsigned long long>(r.io_bytes_per_block),
+                r.delay_bytes_per_sample);
+        fflush(out);
+        first = false;
+
+        fprintf(stderr,
+                "%-16s %-6s block %3zu: %8.2f ns/sample, %6.2f%% of budget",
+                engine.c_str(), quality_name, block_size, r.ns_per_sample,
+                r.budget_pct);
+        const auto base =
+            baseline.find(BaselineKey(engine, quality_name, block_size));
+        if (base != baseline.end() && base->second.ns_per_sample > 0.) {
+          const double before = base->second.ns_per_sample;
+          const double change_pct = (r.ns_per_sample - before) / before * 100.;
+          fprintf(stderr, " (%+.1f%% vs baseline)", change_pct);
+          if (options.max_regression_pct > 0. &&
+              change_pct > options.max_regression_pct) {
+            status = 1;
+          }
+        }
+        if (r.io_bytes_per_block > 0) {
+          fprintf(stderr, ", %llu I/O bytes/block",
+                  static_cast<unsigned long long>(r.io_bytes_per_block));
+          if (base != baseline.end() && base->second.io_bytes_per_block > 0 &&
+              base->second.io_bytes_per_block != r.io_bytes_per_block) {
+            fprintf(stderr, " (%llu before)",
+                    static_cast<unsigned long long>(
+                        base->second.io_bytes_per_block));
+          }
+        }
+        if (r.delay_bytes_per_sample > 0.) {
+          fprintf(stderr, ", %.1f MB/s of delay traffic",
+                  r.delay_bytes_per_sample * host::kEngineSampleRate / 1e6);
+        }
+        fprintf(stderr, "\n");
+      }
+    }
+  }
+  fprintf(out, "\n  ]\n}\n");
+  if (out != stdout) {
+    fclose(out);
+  }
+  return status;
+}
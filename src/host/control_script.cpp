@@ -0,0 +1,199 @@
+/*
+ * Timestamped control scripts for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "control_script.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace host {
+
+// Ramps move the knob in steps this far apart, which is about how often the
+// firmware reads the ADC at the block sizes the effects use.
+constexpr double kRampStepSeconds = 0.001;
+
+// How far an LED may be from the expected brightness.
+constexpr float kLedTolerance = 0.02f;
+
+static bool ParseIndex(std::istringstream &in, size_t count, size_t *index) {
+  int n = 0;
+  if (!(in >> n) || n < 1 || static_cast<size_t>(n) > count) {
+    return false;
+  }
+  *index = static_cast<size_t>(n - 1);
+  return true;
+}
+
+bool ControlScript::Load(const char *path, std::string *error) {
+  std::ifstream file(path);
+  if (!file) {
+    *error = std::string("can't open ") + path;
+    return false;
+  }
+  std::string line;
+  for (int number = 1; std::getline(file, line); number++) {
+    std::string line_error;
+    if (!AddLine(line, &line_error)) {
+      *error = std::string(path) + ":" + std::to_string(number) + ": " +
+               line_error;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ControlScript::AddLine(const std::string &line, std::string *error) {
+  std::istringstream in(line.substr(0, line.find('#')));
+  double seconds = 0.;
+  std::string command;
+  if (!(in >> seconds)) {
+    if (in.eof()) {
+      return true;  // Blank line or comment
+    }
+    *error = "expected a time in seconds";
+    return false;
+  }
+  if (seconds < 0. || !(in >> command)) {
+    *error = "expected a time and a command";
+    return false;
+  }
+
+  size_t index = 0;
+  std::string word;
+  if (command == "knob") {
+    float value = 0.f;
+    if (!ParseIndex(in, Runtime::kNumKnobs, &index) || !(in >> value)) {
+      *error = "usage: TIME knob 1-6 VALUE [ramp SECONDS]";
+      return false;
+    }
+    double ramp_seconds = 0.;
+    if (in >> word) {
+      if (word != "ramp" || !(in >> ramp_seconds) || ramp_seconds < 0.) {
+        *error = "usage: TIME knob 1-6 VALUE [ramp SECONDS]";
+        return false;
+      }
+    }
+    if (ramp_seconds > 0.) {
+      ScheduleRamp(seconds, index, value, ramp_seconds);
+    } else {
+      runtime_.At(seconds, [this, index, value] {
+        runtime_.SetKnob(index, value);
+      });
+    }
+  } else if (command == "toggle") {
+    Runtime::ToggleswitchPosition position;
+    if (!ParseIndex(in, Runtime::kNumToggles, &index) || !(in >> word)) {
+      *error = "usage: TIME toggle 1-3 up|middle|down";
+      return false;
+    }
+    if (word == "up") {
+      position = Runtime::TOGGLE_UP;
+    } else if (word == "middle" || word == "mid") {
+      position = Runtime::TOGGLE_MIDDLE;
+    } else if (word == "down") {
+      position = Runtime::TOGGLE_DOWN;
+    } else {
+      *error = "toggle position must be up, middle or down";
+      return false;
+    }
+    runtime_.At(seconds, [this, index, position] {
+      runtime_.SetToggle(index, position);
+    });
+  } else if (command == "footswitch") {
+    if (!ParseIndex(in, Runtime::kNumFootswitches, &index) ||
+        !(in >> word) || (word != "down" && word != "up" && word != "tap")) {
+      *error = "usage: TIME footswitch 1-2 down|up|tap";
+      return false;
+    }
+    const bool down = word != "up";
+    runtime_.At(seconds, [this, index, down] {
+      runtime_.SetFootswitch(index, down);
+    });
+    if (word == "tap") {
+      runtime_.At(seconds + kTapSeconds, [this, index] {
+        runtime_.SetFootswitch(index, false);
+      });
+    }
+  } else if (command == "expect") {
+    float brightness = 0.f;
+    if (!(in >> word) || word != "led" ||
+        !ParseIndex(in, Runtime::kNumLeds, &index) || !(in >> word)) {
+      *error = "usage: TIME expect led 1-2 on|off|BRIGHTNESS";
+      return false;
+    }
+    if (word == "on") {
+      brightness = 1.f;
+    } else if (word == "off") {
+      brightness = 0.f;
+    } else if (sscanf(word.c_str(), "%f", &brightness) != 1) {
+      *error = "LED brightness must be on, off or a number from 0 to 1";
+      return false;
+    }
+    ExpectLed(seconds, index, brightness);
+  } else if (command == "end") {
+    runtime_.At(seconds, [] { throw RenderFinished{true, "end of script"}; });
+  } else {
+    *error = "unknown command '" + command + "'";
+    return false;
+  }
+
+  if (in >> word) {
+    *error = "unexpected '" + word + "'";
+    return false;
+  }
+  return true;
+}
+
+void ControlScript::ScheduleRamp(double seconds, size_t knob, float target,
+                                 double ramp_seconds) {
+  // Where the ramp starts from isn't known until it starts.
+  runtime_.At(seconds, [this, seconds, knob, target, ramp_seconds] {
+    const float from = runtime_.Knob(knob);
+    const int steps =
+        std::max(1, static_cast<int>(std::ceil(ramp_seconds / kRampStepSeconds)));
+    for (int i = 1; i <= steps; i++) {
+      const double t = static_cast<double>(i) / steps;
+      const float value = from + (target - from) * static_cast<float>(t);
+      runtime_.At(seconds + ramp_seconds * t, [this, knob, value] {
+        runtime_.SetKnob(knob, value);
+      });
+    }
+  });
+}
+
+void ControlScript::ExpectLed(double seconds, size_t led, float brightness) {
+  runtime_.At(seconds, [this, seconds, led, brightness] {
+    checks_++;
+    const float actual = runtime_.LedBrightness(led);
+    if (std::fabs(actual - brightness) > kLedTolerance) {
+      char message[96];
+      snprintf(message, sizeof(message),
+               "%.3f s: expected LED %zu at %.2f but it is %.2f", seconds,
+               led + 1, brightness, actual);
+      failures_.push_back(message);
+    }
+  });
+}
+
+}  // namespace host
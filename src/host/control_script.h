@@ -0,0 +1,85 @@
+/*
+ * Timestamped control scripts for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_CONTROL_SCRIPT_H
+#define HOST_CONTROL_SCRIPT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "host_runtime.h"
+
+namespace host {
+
+/// @brief Schedules knob, toggleswitch and footswitch changes (and checks on
+/// the LEDs) from a text script.
+///
+/// Each line is `TIME COMMAND ARGS...`, with TIME in seconds of simulated
+/// time. Controls are numbered from 1 like they are on the pedal. Anything
+/// after a `#` is a comment.
+///
+///     0.0   knob 3 0.8              # set knob 3 to 0.8
+///     1.0   knob 1 0.2 ramp 2.5     # glide knob 1 to 0.2 over 2.5 seconds
+///     0.0   toggle 2 up             # up, middle or down
+///     0.05  footswitch 2 tap        # press and release after 100 ms
+///     1.0   footswitch 1 down       # hold...
+///     3.5   footswitch 1 up         # ...and let go
+///     4.0   expect led 1 on         # on, off or a brightness from 0 to 1
+///     8.0   end                     # stop rendering
+///
+/// The object has to stay alive until the render is over because the
+/// scheduled events report back to it.
+class ControlScript {
+ public:
+  /// Footswitch taps are held this long, which gets them through the debounce
+  /// without counting as a long press.
+  static constexpr double kTapSeconds = 0.1;
+
+  explicit ControlScript(Runtime &runtime) : runtime_(runtime) {}
+
+  /// @brief Reads a script file and schedules everything in it.
+  /// @return False (with `error` set) if the file can't be read or parsed.
+  bool Load(const char *path, std::string *error);
+
+  /// @brief Parses and schedules a single line.
+  bool AddLine(const std::string &line, std::string *error);
+
+  /// @brief Number of `expect` lines that have been checked so far.
+  size_t Checks() const { return checks_; }
+
+  /// @brief One message per `expect` that did not hold.
+  const std::vector<std::string> &Failures() const { return failures_; }
+
+ private:
+  void ScheduleRamp(double seconds, size_t knob, float target,
+                    double ramp_seconds);
+  void ExpectLed(double seconds, size_t led, float brightness);
+
+  Runtime &runtime_;
+  size_t checks_ = 0;
+  std::vector<std::string> failures_;
+};
+
+}  // namespace host
+
+#endif  // HOST_CONTROL_SCRIPT_H
@@ -0,0 +1,232 @@
+/*
+ * Host (Linux) stand-in for libDaisy
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "daisy_seed.h"
+#include "host_runtime.h"
+
+using host::Runtime;
+
+namespace daisy {
+
+//
+// System
+//
+
+uint32_t System::GetNow() {
+  return static_cast<uint32_t>(Runtime::Get().NowUs() / 1000);
+}
+
+uint32_t System::GetUs() {
+  return static_cast<uint32_t>(Runtime::Get().NowUs());
+}
+
+void System::Delay(uint32_t delay_ms) {
+  Runtime::Get().Delay(static_cast<uint64_t>(delay_ms) * 1000);
+}
+
+void System::DelayUs(uint32_t delay_us) { Runtime::Get().Delay(delay_us); }
+
+void System::ResetToBootloader() {
+  throw host::RenderFinished{false, "the firmware reset to the bootloader"};
+}
+
+//
+// ADC and controls
+//
+
+void AdcHandle::Init(AdcChannelConfig *cfg, size_t num_channels) {
+  num_channels_ = num_channels;
+}
+
+uint16_t *AdcHandle::GetPtr(uint8_t chn) {
+  return Runtime::Get().AdcValue(chn < num_channels_ ? chn : 0);
+}
+
+uint16_t AdcHandle::Get(uint8_t chn) { return *GetPtr(chn); }
+
+float AdcHandle::GetFloat(uint8_t chn) {
+  return static_cast<float>(Get(chn)) / 65536.0f;
+}
+
+void AnalogControl::Init(uint16_t *adcptr, float sr, bool flip, bool invert,
+                         float slew_seconds) {
+  val_ = 0.0f;
+  raw_ = adcptr;
+  samplerate_ = sr;
+  slew_seconds_ = slew_seconds;
+  flip_ = flip;
+  invert_ = invert;
+  SetCoeff(1.0f / (slew_seconds_ * samplerate_ * 0.5f));
+}
+
+float AnalogControl::Process() {
+  float t = static_cast<float>(*raw_) / 65536.0f;
+  if (flip_) {
+    t = 1.f - t;
+  }
+  if (invert_) {
+    t = -t;
+  }
+  val_ += coeff_ * (t - val_);
+  return val_;
+}
+
+void AnalogControl::SetSampleRate(float sample_rate) {
+  samplerate_ = sample_rate;
+  SetCoeff(1.0f / (slew_seconds_ * samplerate_ * 0.5f));
+}
+
+void Switch::Init(Pin pin, float update_rate) {
+  pin_ = pin;
+  last_update_ = System::GetNow();
+  state_ = 0x00;
+  updated_ = false;
+}
+
+void Switch::Debounce() {
+  // Update no faster than 1kHz, same as the hardware.
+  uint32_t now = System::GetNow();
+  updated_ = false;
+  if (now - last_update_ >= 1) {
+    last_update_ = now;
+    updated_ = true;
+    state_ = (state_ << 1) | (RawState() ? 1 : 0);
+    if (state_ == 0x7f) {
+      rising_edge_time_ = now;
+    }
+  }
+}
+
+bool Switch::RawState() { return Runtime::Get().PinActive(pin_.pin); }
+
+void Led::Init(Pin pin, bool invert, float samplerate) { pin_ = pin; }
+
+void Led::Set(float val) { bright_ = val < 0.f ? 0.f : (val > 1.f ? 1.f : val); }
+
+void Led::Update() { Runtime::Get().SetLed(pin_.pin, bright_); }
+
+void Parameter::Init(AnalogControl input, float min, float max, Curve curve) {
+  pmin_ = min;
+  pmax_ = max;
+  pcurve_ = curve;
+  in_ = input;
+  lmin_ = logf(min < 0.0000001f ? 0.0000001f : min);
+  lmax_ = logf(max);
+}
+
+float Parameter::Process() {
+  switch (pcurve_) {
+    case LINEAR:
+      val_ = (in_.Process() * (pmax_ - pmin_)) + pmin_;
+      break;
+    case EXPONENTIAL:
+      val_ = in_.Process();
+      val_ = ((val_ * val_) * (pmax_ - pmin_)) + pmin_;
+      break;
+    case LOGARITHMIC:
+      val_ = expf((in_.Process() * (lmax_ - lmin_)) + lmin_);
+      break;
+    case CUBE:
+      val_ = in_.Process();
+      val_ = ((val_ * (val_ * val_)) * (pmax_ - pmin_)) + pmin_;
+      break;
+    default:
+      break;
+  }
+  return val_;
+}
+
+//
+// DaisySeed
+//
+
+void DaisySeed::StartAudio(AudioHandle::InterleavingAudioCallback cb) {
+  Runtime::Get().StartAudio(cb);
+}
+
+void DaisySeed::StartAudio(AudioHandle::AudioCallback cb) {
+  Runtime::Get().StartAudio(cb);
+}
+
+void DaisySeed::ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb) {
+  Runtime::Get().StartAudio(cb);
+}
+
+void DaisySeed::ChangeAudioCallback(AudioHandle::AudioCallback cb) {
+  Runtime::Get().StartAudio(cb);
+}
+
+void DaisySeed::StopAudio() { Runtime::Get().StopAudio(); }
+
+void DaisySeed::SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate) {
+  float sr = 48000.f;
+  switch (samplerate) {
+    case SaiHandle::Config::SampleRate::SAI_8KHZ:
+      sr = 8000.f;
+      break;
+    case SaiHandle::Config::SampleRate::SAI_16KHZ:
+      sr = 16000.f;
+      break;
+    case SaiHandle::Config::SampleRate::SAI_32KHZ:
+      sr = 32000.f;
+      break;
+    case SaiHandle::Config::SampleRate::SAI_48KHZ:
+      sr = 48000.f;
+      break;
+    case SaiHandle::Config::SampleRate::SAI_96KHZ:
+      sr = 96000.f;
+      break;
+  }
+  Runtime::Get().SetSampleRate(sr);
+}
+
+float DaisySeed::AudioSampleRate() { return Runtime::Get().SampleRate(); }
+
+void DaisySeed::SetAudioBlockSize(size_t blocksize) {
+  Runtime::Get().SetBlockSize(blocksize);
+}
+
+size_t DaisySeed::AudioBlockSize() { return Runtime::Get().BlockSize(); }
+
+float DaisySeed::AudioCallbackRate() const {
+  return Runtime::Get().SampleRate() /
+         static_cast<float>(Runtime::Get().BlockSize());
+}
+
+void DaisySeed::PrintLine(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+void DaisySeed::Print(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+}
+
+}  // namespace daisy
@@ -0,0 +1,498 @@
+/*
+ * DSP engines wrapped for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "engines.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+#include "Dattorro.hpp"
+#include "ReducedRateDattorro.hpp"
+#include "ap_demo.hpp"
+#include "common.hpp"
+#include "datorro_plate.hpp"
+#include "mutable_rings.hpp"
+#include "other/reverbsploodge.h"
+
+namespace host {
+
+namespace {
+
+/// Delay memory for the Plateau engines: the firmware's arena, or one of the
+/// engine's own (see EngineMemory).
+class PlateauMemory {
+ public:
+  explicit PlateauMemory(EngineMemory memory) {
+    if (memory == EngineMemory::kPrivate) {
+      memory_.reset(new float[kPrivateLength]());
+      private_.emplace(memory_.get(), kPrivateLength);
+    }
+  }
+
+  DelayArena &arena() { return private_ ? *private_ : delayArena; }
+
+  /// Nothing in the arena has overflowed it, this engine's delays or (for
+  /// the shared arena) any other's.
+  bool Fits() const {
+    return (private_ ? *private_ : delayArena).failedCount() == 0;
+  }
+
+  /// Places the delays as the firmware does at boot. Private memory isn't
+  /// placed, since the placement is shared by every engine.
+  void Place() {
+    if (!private_) {
+      delayPlacement.place();
+    }
+  }
+
+ private:
+  /// Enough for a plate at 48 kHz with a 4x time scale.
+  static constexpr size_t kPrivateLength = 1 << 19;
+
+  std::unique_ptr<float[]> memory_;
+  std::optional<DelayArena> private_;
+};
+
+ReverbQuality ToReverbQuality(EngineQuality quality) {
+  switch (quality) {
+    case EngineQuality::kLow: return QUALITY_LOW;
+    case EngineQuality::kMedium: return QUALITY_MEDIUM;
+    case EngineQuality::kHigh: return QUALITY_HIGH;
+  }
+  return QUALITY_HIGH;
+}
+
+/// Dattorro plate as set up by Platerra, with Platerra's knob mapping.
+class DattorroEngine : public Engine {
+ public:
+  explicit DattorroEngine(EngineMemory memory = EngineMemory::kShared)
+      : DattorroEngine(kEngineSampleRate, memory) {}
+
+  /// @param plate_rate Rate the plate runs at, behind ReducedRateDattorro's
+  /// resamplers when it's below kEngineSampleRate.
+  DattorroEngine(float plate_rate, EngineMemory memory)
+      : memory_(memory),
+        arena_start_(memory_.arena().bytesUsed()),
+        verb_(plate_rate, 16, 4.0, memory_.arena()) {
+    memory_bytes_ = memory_.arena().bytesUsed() - arena_start_;
+    wet_.setSampleRates(kEngineSampleRate, plate_rate);
+    verb_.setTimeScale(1.007500);
+    verb_.setPreDelay(0.);
+    verb_.setInputFilterLowCutoffPitch(0.);
+    verb_.setInputFilterHighCutoffPitch(10000.);
+    verb_.enableInputDiffusion(true);
+    verb_.setTankFilterLowCutFrequency(0.);
+    verb_.setTankFilterHighCutFrequency(10000.);
+    verb_.setTankModShape(0.5);
+    memory_.Place();  // As the firmware does at boot
+  }
+
+  void Automate(const float *knobs) override {
+    verb_.setDecay(knobs[2]);
+    verb_.setTankDiffusion(knobs[3]);
+    verb_.setInputFilterHighCutoffPitch(knobs[4] * 10.f);
+    verb_.setTankFilterHighCutFrequency(knobs[5] * 10.f);
+    verb_.setTankModSpeed(knobs[0]);
+    verb_.setTankModDepth(knobs[1]);
+  }
+
+  void Process(const float *in_left, const float *in_right, float *out_left,
+               float *out_right, size_t size) override {
+    wet_.process(in_left, in_right, out_left, out_right, size);
+    for (size_t i = 0; i < size; i++) {
+      out_left[i] = in_left[i] * 0.5f + out_left[i] * 0.5f;
+      out_right[i] = in_right[i] * 0.5f + out_right[i] * 0.5f;
+    }
+  }
+
+  size_t MemoryBytes() const override { return memory_bytes_; }
+  bool MemoryFits() const override { return memory_.Fits(); }
+
+  /// Platerra's defaults, and the time scale it fixes.
+  const std::vector<EngineParameter> &Parameters() const override {
+    static const std::vector<EngineParameter> parameters = {
+        {"decay", 0.f, 1.f, 0.67f},
+        {"diffusion", 0.f, 1.f, 0.7f},
+        {"input_damp", 0.f, 10.f, 6.77f},
+        {"tank_damp", 0.f, 10.f, 6.77f},
+        {"mod_speed", 0.f, 1.f, 1.f},
+        {"mod_depth", 0.f, 1.f, 0.5f},
+        {"mod_shape", 0.f, 1.f, 0.75f},
+        {"time_scale", 0.25f, 4.f, 1.0075f},
+    };
+    return parameters;
+  }
+
+  void SetParameter(size_t index, float value) override {
+    switch (index) {
+      case 0: verb_.setDecay(value); break;
+      case 1: verb_.setTankDiffusion(value); break;
+      case 2: verb_.setInputFilterHighCutoffPitch(value); break;
+      case 3: verb_.setTankFilterHighCutFrequency(value); break;
+      case 4: verb_.setTankModSpeed(value); break;
+      case 5: verb_.setTankModDepth(value); break;
+      case 6: verb_.setTankModShape(value); break;
+      case 7: verb_.setTimeScale(value); break;
+    }
+  }
+
+  bool SetQuality(EngineQuality quality) override {
+    verb_.setQuality(ToReverbQuality(quality));
+    return true;
+  }
+
+ protected:
+  PlateauMemory memory_;
+  size_t arena_start_;  // Before verb_ is built
+  Dattorro verb_;
+  ReducedRateDattorro wet_{verb_};
+  size_t memory_bytes_ = 0;
+};
+
+/// Dattorro as Platerra runs it with the mod depth switch at 0: no tank
+/// modulation and whole-sample delays, so it runs the cheapest tank loop.
+class DattorroStaticEngine : public DattorroEngine {
+ public:
+  explicit DattorroStaticEngine(EngineMemory memory)
+      : DattorroEngine(kEngineSampleRate, memory) {
+    verb_.setWholeSampleDelays(true);
+    verb_.setTankModDepth(0.);
+  }
+
+  void Automate(const float *knobs) override {
+    verb_.setDecay(knobs[2]);
+    verb_.setTankDiffusion(knobs[3]);
+    verb_.setInputFilterHighCutoffPitch(knobs[4] * 10.f);
+    verb_.setTankFilterHighCutFrequency(knobs[5] * 10.f);
+  }
+};
+
+/// The Dattorro plate at a reduced internal rate, with the resampling around
+/// it.
+template <int kPlateRate>
+class ReducedRateDattorroEngine : public DattorroEngine {
+ public:
+  explicit ReducedRateDattorroEngine(EngineMemory memory)
+      : DattorroEngine(kPlateRate, memory) {}
+};
+
+/// The Dattorro tank on its own, without the input filters and diffusers.
+class DattorroTankEngine : public Engine {
+ public:
+  explicit DattorroTankEngine(EngineMemory memory)
+      : memory_(memory),
+        arena_start_(memory_.arena().bytesUsed()),
+        tank_(kEngineSampleRate, 16, 4.0, memory_.arena()) {
+    memory_bytes_ = memory_.arena().bytesUsed() - arena_start_;
+    tank_.setSampleRate(kEngineSampleRate);
+    tank_.setTimeScale(1.007500);
+    tank_.setLowCutFrequency(20.);
+    tank_.setModShape(0.5);
+    memory_.Place();
+  }
+
+  void Automate(const float *knobs) override {
+    tank_.setDecay(knobs[2]);
+    tank_.setDiffusion(knobs[3]);
+    tank_.setHighCutFrequency(440. * std::pow(2., knobs[5] * 10. - 5.));
+    tank_.setModSpeed(knobs[0]);
+    tank_.setModDepth(knobs[1]);
+  }
+
+  bool SetQuality(EngineQuality quality) override {
+    tank_.setQuality(ToReverbQuality(quality));
+    return true;
+  }
+
+  void Process(const float *in_left, const float *in_right, float *out_left,
+               float *out_right, size_t size) override {
+    tank_.process(in_left, in_right, out_left, out_right, size);
+  }
+
+  size_t MemoryBytes() const override { return memory_bytes_; }
+  bool MemoryFits() const override { return memory_.Fits(); }
+
+ private:
+  PlateauMemory memory_;
+  size_t arena_start_;  // Before tank_ is built
+  Dattorro1997Tank tank_;
+  size_t memory_bytes_ = 0;
+};
+
+/// The FxEngine reverbs from MutableRings, with MutableRings' knob mappings.
+/// Like the firmware, they read the planar buffers and write their mix
+/// straight into the output ones.
+template <typename Reverb>
+class FxEngineReverb : public Engine {
+ public:
+  FxEngineReverb() : buffer_(new StorageArray<Reverb::kFormat>()), verb_(*buffer_) {
+    verb_.Init(kEngineSampleRate);
+    verb_.set_input_gain(0.2f);
+  }
+
+  void Automate(const float *knobs) override { SetKnobs(verb_, knobs); }
+
+  void Process(const float *in_left, const float *in_right, float *out_left,
+               float *out_right, size_t size) override {
+    verb_.Process(StereoIn::Planar(in_left, in_right, size),
+                  StereoOut::Planar(out_left, out_right, size));
+  }
+
+  /// What the reverb's topology reserves, worked out at compile time. The
+  /// buffer itself is kDelayBufferLength samples whatever the reverb.
+  size_t MemoryBytes() const override {
+    return Reverb::Memory::Bytes(Reverb::kFormat);
+  }
+
+  double DelayBytesPerSample() const override {
+    return Reverb::Memory::kAccessesPerSample * BitsPerSample(Reverb::kFormat) /
+           8.0;
+  }
+
+  const std::vector<EngineParameter> &Parameters() const override {
+    return ParametersOf(verb_);
+  }
+
+  void SetParameter(size_t index, float value) override {
+    SetParameter(verb_, index, value);
+  }
+
+  bool SetQuality(EngineQuality quality) override {
+    if constexpr (requires { verb_.set_quality(FxEngineBase::QUALITY_HIGH); }) {
+      verb_.set_quality(quality == EngineQuality::kLow      ? FxEngineBase::QUALITY_LOW
+                        : quality == EngineQuality::kMedium ? FxEngineBase::QUALITY_MEDIUM
+                                                            : FxEngineBase::QUALITY_HIGH);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+ private:
+  // The fallbacks are where the knobs put them at halfway.
+  template <Format format>
+  static const std::vector<EngineParameter> &ParametersOf(
+      const MutableRings<format> &) {
+    static const std::vector<EngineParameter> parameters = {
+        {"amount", 0.f, 1.f, 0.25f},
+        {"time", 0.f, 1.f, 0.665f},
+        {"lp", 0.f, 1.f, 0.6f},
+    };
+    return parameters;
+  }
+
+  template <Format format>
+  static const std::vector<EngineParameter> &ParametersOf(
+      const DatorroPlate<format> &) {
+    static const std::vector<EngineParameter> parameters = {
+        {"amount", 0.f, 1.f, 0.25f},
+        {"time", 0.f, 1.f, 0.675f},
+        {"lp", 0.f, 1.f, 0.65f},
+    };
+    return parameters;
+  }
+
+  template <Format format>
+  static const std::vector<EngineParameter> &ParametersOf(
+      const AllPassDemo<format> &) {
+    static const std::vector<EngineParameter> parameters = {
+        {"amount", 0.f, 1.f, 0.5f},
+        {"size", 0.f, 1.f, 0.5f},
+        {"diffusion", 0.f, 1.f, 0.5f},
+    };
+    return parameters;
+  }
+
+  template <typename T>
+  static void SetParameter(T &verb, size_t index, float value) {
+    switch (index) {
+      case 0: verb.set_amount(value); break;
+      case 1: verb.set_time(value); break;
+      case 2: verb.set_lp(value); break;
+    }
+  }
+
+  template <Format format>
+  static void SetParameter(AllPassDemo<format> &verb, size_t index,
+                           float value) {
+    switch (index) {
+      case 0: verb.set_amount(value); break;
+      case 1: verb.set_size(value); break;
+      case 2: verb.set_diffusion(value); break;
+    }
+  }
+
+  template <Format format>
+  static void SetKnobs(MutableRings<format> &verb, const float *knobs) {
+    verb.set_amount(knobs[0] * 0.5f);
+    verb.set_time(0.35f + 0.63f * knobs[1]);
+    verb.set_input_gain(0.2f);
+    verb.set_lp(0.3f + knobs[2] * 0.6f);
+  }
+
+  template <Format format>
+  static void SetKnobs(DatorroPlate<format> &verb, const float *knobs) {
+    verb.set_amount(knobs[0] * 0.5f);
+    verb.set_time(0.35f + 0.65f * knobs[1]);
+    verb.set_input_gain(0.2f);
+    verb.set_lp(0.3f + knobs[2] * 0.7f);
+  }
+
+  template <Format format>
+  static void SetKnobs(AllPassDemo<format> &verb, const float *knobs) {
+    verb.set_amount(knobs[0]);
+    verb.set_input_gain(0.2f);
+    verb.set_size(knobs[1]);
+    verb.set_diffusion(knobs[2]);
+  }
+
+  std::unique_ptr<StorageArray<Reverb::kFormat>> buffer_;
+  Reverb verb_;
+};
+
+class ReverbSploodgeEngine : public Engine {
+ public:
+  ReverbSploodgeEngine() { verb_.Init(kEngineSampleRate); }
+
+  void Automate(const float *knobs) override {
+    verb_.SetFeedback(knobs[0]);
+    verb_.SetDryWet(knobs[1]);
+    verb_.SetWetTone(knobs[2]);
+    verb_.SetSploodge(knobs[3]);
+  }
+
+  void Process(const float *in_left, const float *in_right, float *out_left,
+               float *out_right, size_t size) override {
+    for (size_t i = 0; i < size; i++) {
+      verb_.Process(in_left[i], in_right[i], &out_left[i], &out_right[i]);
+    }
+  }
+
+  size_t MemoryBytes() const override { return sizeof(verb_); }
+
+ private:
+  daisysp::ReverbSploodge verb_;
+};
+
+template <typename T>
+std::unique_ptr<Engine> Make(EngineMemory memory) {
+  if constexpr (std::is_constructible_v<T, EngineMemory>) {
+    return std::make_unique<T>(memory);
+  } else {
+    // Falling back would quietly put a plate's lines in the shared arena.
+    static_assert(!std::is_constructible_v<T, float, EngineMemory>,
+                  "engines with an EngineMemory need a constructor taking "
+                  "only that");
+    return std::make_unique<T>();
+  }
+}
+
+struct EngineEntry {
+  const char *name;
+  std::unique_ptr<Engine> (*make)(EngineMemory);
+  bool qualities;  ///< Whether SetQuality() does anything
+};
+
+const EngineEntry kEngines[] = {
+    {"dattorro", Make<DattorroEngine>, true},
+    {"dattorro_static", Make<DattorroStaticEngine>, true},
+    {"dattorro_32k", Make<ReducedRateDattorroEngine<32000>>, true},
+    {"dattorro_24k", Make<ReducedRateDattorroEngine<24000>>, true},
+    {"dattorro_tank", Make<DattorroTankEngine>, true},
+    {"mutable_rings", Make<FxEngineReverb<MutableRings<>>>, true},
+    {"mutable_rings_16", Make<FxEngineReverb<MutableRings<FORMAT_16_BIT>>>, true},
+    {"mutable_rings_12", Make<FxEngineReverb<MutableRings<FORMAT_12_BIT>>>, true},
+    {"datorro_plate", Make<FxEngineReverb<DatorroPlate<>>>, true},
+    {"datorro_plate_16", Make<FxEngineReverb<DatorroPlate<FORMAT_16_BIT>>>, true},
+    {"datorro_plate_12", Make<FxEngineReverb<DatorroPlate<FORMAT_12_BIT>>>, true},
+    {"ap_demo", Make<FxEngineReverb<AllPassDemo<>>>, false},
+    {"reverb_sploodge", Make<ReverbSploodgeEngine>, false},
+};
+
+}  // namespace
+
+const std::vector<std::string> &EngineNames() {
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> v;
+    for (const EngineEntry &entry : kEngines) {
+      v.push_back(entry.name);
+    }
+    return v;
+  }();
+  return names;
+}
+
+const char *QualityName(EngineQuality quality) {
+  switch (quality) {
+    case EngineQuality::kLow: return "low";
+    case EngineQuality::kMedium: return "medium";
+    case EngineQuality::kHigh: return "high";
+  }
+  return "high";
+}
+
+bool ParseQuality(const char *name, EngineQuality *quality) {
+  for (EngineQuality q :
+       {EngineQuality::kLow, EngineQuality::kMedium, EngineQuality::kHigh}) {
+    if (strcmp(name, QualityName(q)) == 0) {
+      *quality = q;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool EngineHasQualities(const std::string &name) {
+  for (const EngineEntry &entry : kEngines) {
+    if (name == entry.name) {
+      return entry.qualities;
+    }
+  }
+  return false;
+}
+
+const std::vector<EngineParameter> &Engine::Parameters() const {
+  static const std::vector<EngineParameter> none;
+  return none;
+}
+
+std::unique_ptr<Engine> MakeEngine(const std::string &name,
+                                   EngineMemory memory) {
+  for (const EngineEntry &entry : kEngines) {
+    if (name == entry.name) {
+      return entry.make(memory);
+    }
+  }
+  return nullptr;
+}
+
+float AutomatedKnob(size_t knob, double seconds) {
+  static constexpr double kRatesHz[kEngineKnobs] = {0.11, 0.17, 0.23,
+                                                    0.07, 0.13, 0.19};
+  return static_cast<float>(
+      0.5 + 0.45 * sin(2. * M_PI * kRatesHz[knob] * seconds + knob));
+}
+
+}  // namespace host
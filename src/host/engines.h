@@ -0,0 +1,139 @@
+/*
+ * DSP engines wrapped for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_ENGINES_H
+#define HOST_ENGINES_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace host {
+
+/// Every engine runs at this rate, which is what the effects use.
+constexpr float kEngineSampleRate = 48000.f;
+
+/// Number of knobs an engine can be driven with (the same as the pedal).
+constexpr size_t kEngineKnobs = 6;
+
+/// @brief Where an engine's delay memory comes from.
+enum class EngineMemory {
+  /// The Plateau engines share the firmware's delay arena and have their
+  /// delays placed the way the firmware does at boot.
+  kShared,
+  /// Every engine gets delay memory of its own and nothing is placed, so
+  /// engines can be built and run on several threads at once.
+  kPrivate,
+};
+
+/// @brief The CPU/quality tiers of the reverbs. What each one gives up is up
+/// to the engine (see Dattorro::setQuality() and FxEngineBase::Quality).
+enum class EngineQuality {
+  kLow,
+  kMedium,
+  kHigh,
+};
+
+/// @brief "low", "medium" or "high".
+const char *QualityName(EngineQuality quality);
+
+/// @brief The tier named `name` (see QualityName()).
+/// @return false if there is no such tier.
+bool ParseQuality(const char *name, EngineQuality *quality);
+
+/// @brief A parameter that an engine can be swept over with SetParameter().
+struct EngineParameter {
+  const char *name;
+  float min;
+  float max;
+  float fallback;  ///< The value when a sweep leaves the parameter alone
+};
+
+/// @brief A DSP engine on its own, outside of any firmware, driven with six
+/// knob values the way the effect that uses it maps its knobs.
+///
+/// With EngineMemory::kShared several of the engines keep their delay memory
+/// in globals, so create at most one engine per process.
+class Engine {
+ public:
+  virtual ~Engine() = default;
+
+  /// @brief Applies the knob positions (0 to 1). Call it once per block,
+  /// which is how the firmware reads its controls.
+  virtual void Automate(const float *knobs) = 0;
+
+  virtual void Process(const float *in_left, const float *in_right,
+                       float *out_left, float *out_right, size_t size) = 0;
+
+  /// @brief Bytes of delay memory the engine uses.
+  virtual size_t MemoryBytes() const = 0;
+
+  /// @brief Whether every delay got the memory it asked for. A delay that
+  /// didn't fit runs on a scratch line shared with the others that didn't,
+  /// and its output means nothing.
+  virtual bool MemoryFits() const { return true; }
+
+  /// @brief Bytes of audio moved per frame on the way in and out: reading
+  /// the stereo input and writing the stereo output once is 16, and any
+  /// copying or converting around the DSP adds to that.
+  virtual size_t IoBytesPerFrame() const { return 4 * sizeof(float); }
+
+  /// @brief Bytes of delay memory read and written per sample, in the
+  /// engine's storage format, or 0 if the engine doesn't know.
+  virtual double DelayBytesPerSample() const { return 0.; }
+
+  /// @brief The engine's parameters in the units its DSP code takes, rather
+  /// than as knob positions. Empty if the engine can't be swept.
+  virtual const std::vector<EngineParameter> &Parameters() const;
+
+  /// @brief Sets parameter `index` of Parameters(). Use either this or
+  /// Automate(), not both.
+  virtual void SetParameter(size_t index, float value) {}
+
+  /// @brief Moves the engine to another tier. Engines start at kHigh, which
+  /// is how they have always run.
+  /// @return false if the engine has no tiers, in which case it stays as it
+  /// is.
+  virtual bool SetQuality(EngineQuality quality) { return false; }
+};
+
+/// @brief Names that MakeEngine() accepts, in a fixed order.
+const std::vector<std::string> &EngineNames();
+
+/// @brief Whether the engine called `name` has tiers (see
+/// Engine::SetQuality()).
+bool EngineHasQualities(const std::string &name);
+
+/// @brief Creates an engine by name.
+/// @return nullptr if there is no such engine.
+std::unique_ptr<Engine> MakeEngine(const std::string &name,
+                                   EngineMemory memory = EngineMemory::kShared);
+
+/// @brief Where each knob sits at a given time in the standard automation.
+/// Every knob follows its own slow sine so that different parameter
+/// combinations come up over a run.
+float AutomatedKnob(size_t knob, double seconds);
+
+}  // namespace host
+
+#endif  // HOST_ENGINES_H
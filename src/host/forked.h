@@ -0,0 +1,77 @@
+/*
+ * Run a piece of work in a child process
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_FORKED_H
+#define HOST_FORKED_H
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <type_traits>
+
+namespace host {
+
+/// @brief Runs `work` in a forked child and copies its result back.
+///
+/// The effects and engines keep their state (and their delay memory) in
+/// globals, so the only way to start each run from power-on state is a fresh
+/// process. The child gets a copy of the parent as it is now, including
+/// anything that was set up before the call.
+///
+/// @return False if the child could not be started or died before it
+/// returned a result.
+template <typename Result, typename Work>
+bool RunForked(Work work, Result *result) {
+  static_assert(std::is_trivially_copyable<Result>::value,
+                "results are copied through a pipe");
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  fflush(nullptr);
+  const pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    const Result r = work();
+    const bool written = write(fds[1], &r, sizeof(r)) ==
+                         static_cast<ssize_t>(sizeof(r));
+    fflush(nullptr);
+    _exit(written ? 0 : 1);
+  }
+  close(fds[1]);
+  const bool ok = read(fds[0], result, sizeof(*result)) ==
+                  static_cast<ssize_t>(sizeof(*result));
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}  // namespace host
+
+#endif  // HOST_FORKED_H
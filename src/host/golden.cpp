@@ -0,0 +1,537 @@
+/*
+ * Golden-output regression check for the Hothouse DSP engines
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// Renders a fixed set of test signals through every engine and compares the
+// result with reference renders recorded earlier. Record the references on a
+// known-good build, then run the check after changing DSP code:
+//
+//   build/golden record    # before
+//   build/golden check     # after
+//
+// Every case runs in a forked child so that it starts from power-on state.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Flick/extended_oscillator.h"
+#include "analysis.h"
+#include "dsp/delays/DelayArena.hpp"
+#include "engines.h"
+#include "forked.h"
+#include "wav_file.h"
+
+using clevelandmusicco::ExtendedOscillator;
+using host::Engine;
+using host::kEngineSampleRate;
+
+namespace {
+
+// Small enough that knob changes land often, and the block size most of the
+// effects use.
+constexpr size_t kBlockSize = 48;
+
+// How long every signal keeps going after its input ends, for the tails.
+constexpr double kTailSeconds = 2.;
+
+//
+// Test signals
+//
+
+struct Signal {
+  std::vector<float> left;
+  std::vector<float> right;
+};
+
+size_t Frames(double seconds) {
+  return static_cast<size_t>(seconds * kEngineSampleRate);
+}
+
+/// A repeatable noise source, so that references don't depend on the C
+/// library's rand().
+class Noise {
+ public:
+  float Next() {
+    seed_ = seed_ * 1664525u + 1013904223u;
+    return static_cast<float>(seed_ >> 8) / 8388608.f - 1.f;
+  }
+
+ private:
+  uint32_t seed_ = 22222;
+};
+
+/// One full-scale sample on each channel, the left one first.
+Signal Impulse() {
+  Signal s;
+  s.left.assign(Frames(0.5 + kTailSeconds), 0.f);
+  s.right = s.left;
+  s.left[Frames(0.01)] = 1.f;
+  s.right[Frames(0.25)] = 1.f;
+  return s;
+}
+
+/// Exponential sine sweep from 20 Hz to 20 kHz.
+Signal SineSweep() {
+  constexpr double kSeconds = 3.;
+  constexpr double kStartHz = 20.;
+  constexpr double kEndHz = 20000.;
+  const double rate = log(kEndHz / kStartHz);
+  Signal s;
+  s.left.assign(Frames(kSeconds + kTailSeconds), 0.f);
+  for (size_t i = 0; i < Frames(kSeconds); i++) {
+    const double t = i / static_cast<double>(kEngineSampleRate);
+    const double phase =
+        2. * M_PI * kStartHz * kSeconds / rate * (exp(t * rate / kSeconds) - 1.);
+    s.left[i] = static_cast<float>(0.5 * sin(phase));
+  }
+  s.right = s.left;
+  return s;
+}
+
+/// 50 ms bursts of white noise, uncorrelated between the channels, every
+/// half second.
+Signal NoiseBursts() {
+  Noise noise;
+  Signal s;
+  s.left.assign(Frames(2. + kTailSeconds), 0.f);
+  s.right = s.left;
+  for (size_t burst = 0; burst < 4; burst++) {
+    const size_t start = Frames(burst * 0.5);
+    for (size_t i = 0; i < Frames(0.05); i++) {
+      s.left[start + i] = 0.5f * noise.Next();
+      s.right[start + i] = 0.5f * noise.Next();
+    }
+  }
+  return s;
+}
+
+/// A stand-in for a guitar DI recording: Karplus-Strong strums of a short
+/// chord progression, played twice as a loop. It has the sharp attacks and
+/// the long decaying harmonics that a real DI has.
+Signal GuitarLoop() {
+  constexpr double kStrumSeconds = 0.5;
+  constexpr double kChordsHz[][4] = {{82.41, 123.47, 164.81, 196.00},
+                                     {110.00, 164.81, 220.00, 261.63},
+                                     {98.00, 146.83, 196.00, 246.94},
+                                     {73.42, 110.00, 146.83, 185.00}};
+  Noise noise;
+  std::vector<float> loop(Frames(kStrumSeconds * 4), 0.f);
+  for (size_t chord = 0; chord < 4; chord++) {
+    for (size_t string = 0; string < 4; string++) {
+      // Strings are strummed 15 ms apart, low to high.
+      const size_t start = Frames(chord * kStrumSeconds + string * 0.015);
+      std::vector<float> line(Frames(1. / kChordsHz[chord][string]));
+      for (float &x : line) {
+        x = noise.Next();
+      }
+      for (size_t i = 0, p = 0; start + i < loop.size(); i++) {
+        const size_t next = (p + 1) % line.size();
+        const float out = line[p];
+        line[p] = 0.996f * 0.5f * (line[p] + line[next]);
+        p = next;
+        loop[start + i] += 0.15f * out;
+      }
+    }
+  }
+  Signal s;
+  s.left = loop;
+  s.left.insert(s.left.end(), loop.begin(), loop.end());
+  s.left.resize(s.left.size() + Frames(kTailSeconds), 0.f);
+  s.right = s.left;
+  return s;
+}
+
+/// The oscillators have no input, so they get silence to set the length.
+Signal Silence() {
+  Signal s;
+  s.left.assign(Frames(4.5), 0.f);
+  s.right = s.left;
+  return s;
+}
+
+struct SignalEntry {
+  const char *name;
+  Signal (*make)();
+};
+
+const SignalEntry kCorpus[] = {
+    {"impulse", Impulse},
+    {"sine_sweep", SineSweep},
+    {"noise_bursts", NoiseBursts},
+    {"guitar_loop", GuitarLoop},
+};
+
+const SignalEntry kOscillatorSignal = {"freq_sweep", Silence};
+
+//
+// Engines
+//
+
+const char *const kWaveforms[] = {
+    "sin",          "tri",           "saw",
+    "ramp",         "square",        "polyblep_tri",
+    "polyblep_saw", "polyblep_square", "square_rounded",
+};
+static_assert(sizeof(kWaveforms) / sizeof(kWaveforms[0]) ==
+                  ExtendedOscillator::WAVE_LAST,
+              "a waveform is missing");
+
+/// One ExtendedOscillator waveform, swept up two octaves a second from
+/// 20 Hz, on both channels. The input is ignored.
+class OscillatorEngine : public Engine {
+ public:
+  explicit OscillatorEngine(uint8_t waveform) {
+    osc_.Init(kEngineSampleRate);
+    osc_.SetWaveform(waveform);
+    osc_.SetAmp(0.5f);
+    osc_.SetPw(0.3f);
+  }
+
+  void Automate(const float *knobs) override {}
+
+  void Process(const float *in_left, const float *in_right, float *out_left,
+               float *out_right, size_t size) override {
+    for (size_t i = 0; i < size; i++) {
+      const float seconds = frame_++ / kEngineSampleRate;
+      osc_.SetFreq(20.f * exp2f(2.f * seconds));
+      out_left[i] = out_right[i] = osc_.Process();
+    }
+  }
+
+  size_t MemoryBytes() const override { return 0; }
+
+ private:
+  ExtendedOscillator osc_;
+  size_t frame_ = 0;
+};
+
+/// How far a render may be from its reference before the check fails.
+struct Tolerance {
+  double max_abs_error;
+  double spectral_db;
+};
+
+struct Case {
+  std::string engine;
+  const SignalEntry *signal;
+  Tolerance tolerance;
+  int waveform;  // For the oscillators, otherwise -1
+};
+
+// The Plateau engines run their filters and modulation in double and
+// recompute coefficients from the knobs, so they get the most room for
+// rounding changes. The oscillators are a handful of float operations per
+// sample.
+Tolerance ToleranceFor(const std::string &engine) {
+  if (engine.rfind("dattorro", 0) == 0) {
+    return {1e-4, 0.1};
+  }
+  if (engine == "reverb_sploodge") {
+    return {1e-4, 0.1};
+  }
+  if (engine.rfind("oscillator_", 0) == 0) {
+    return {1e-6, 0.01};
+  }
+  return {1e-5, 0.05};  // The FxEngine reverbs
+}
+
+std::vector<Case> AllCases() {
+  std::vector<Case> cases;
+  for (const std::string &engine : host::EngineNames()) {
+    for (const SignalEntry &signal : kCorpus) {
+      cases.push_back({engine, &signal, ToleranceFor(engine), -1});
+    }
+  }
+  for (int w = 0; w < ExtendedOscillator::WAVE_LAST; w++) {
+    const std::string engine = std::string("oscillator_") + kWaveforms[w];
+    cases.push_back({engine, &kOscillatorSignal, ToleranceFor(engine), w});
+  }
+  return cases;
+}
+
+//
+// Rendering and comparing
+//
+
+Signal Render(const Case &c) {
+  std::unique_ptr<Engine> engine =
+      c.waveform >= 0 ? std::make_unique<OscillatorEngine>(c.waveform)
+                      : host::MakeEngine(c.engine);
+  const Signal in = c.signal->make();
+  Signal out;
+  out.left.resize(in.left.size());
+  out.right.resize(in.right.size());
+  float knobs[host::kEngineKnobs];
+  for (size_t frame = 0; frame < in.left.size(); frame += kBlockSize) {
+    const size_t n = std::min(kBlockSize, in.left.size() - frame);
+    const double seconds = frame / static_cast<double>(kEngineSampleRate);
+    for (size_t k = 0; k < host::kEngineKnobs; k++) {
+      knobs[k] = host::AutomatedKnob(k, seconds);
+    }
+    engine->Automate(knobs);
+    engine->Process(&in.left[frame], &in.right[frame], &out.left[frame],
+                    &out.right[frame], n);
+  }
+  return out;
+}
+
+bool WriteWav(const std::string &path, const Signal &s) {
+  host::WavWriter writer;
+  if (!writer.Open(path.c_str(), kEngineSampleRate,
+                   host::WavWriter::Format::FLOAT32)) {
+    return false;
+  }
+  writer.Write(s.left.data(), s.right.data(), s.left.size());
+  return writer.Close();
+}
+
+bool ReadWav(const std::string &path, Signal *s) {
+  host::WavReader reader;
+  std::string error;
+  if (!reader.Open(path.c_str(), &error)) {
+    return false;
+  }
+  s->left.resize(reader.Frames());
+  s->right.resize(reader.Frames());
+  return reader.Read(s->left.data(), s->right.data(), reader.Frames()) ==
+         reader.Frames();
+}
+
+/// What a child sends back to the parent, so it has to stay trivially
+/// copyable.
+struct CaseResult {
+  enum Status {
+    OK,
+    FAILED,
+    NO_REFERENCE,
+    LENGTH_MISMATCH,
+    IO_ERROR,
+    OUT_OF_MEMORY,
+  } status;
+  double max_abs_error;
+  double spectral_db;
+  size_t frames;
+  size_t reference_frames;
+};
+
+struct Options {
+  bool record = false;
+  bool exact = false;
+  std::string dir = "golden";
+  std::vector<std::string> engines;
+};
+
+std::string ReferencePath(const Options &options, const Case &c,
+                          const char *suffix = ".wav") {
+  return options.dir + "/" + c.engine + "/" + c.signal->name + suffix;
+}
+
+CaseResult RunCase(const Case &c, const Options &options) {
+  CaseResult result = {};
+  const Signal actual = Render(c);
+  result.frames = actual.left.size();
+  if (delayArena.failedCount() != 0) {
+    // The render went through a scratch line, so don't record or compare it.
+    result.status = CaseResult::OUT_OF_MEMORY;
+    return result;
+  }
+
+  if (options.record) {
+    std::error_code ec;
+    std::filesystem::create_directories(options.dir + "/" + c.engine, ec);
+    result.status = !ec && WriteWav(ReferencePath(options, c), actual)
+                        ? CaseResult::OK
+                        : CaseResult::IO_ERROR;
+    return result;
+  }
+
+  Signal reference;
+  if (!ReadWav(ReferencePath(options, c), &reference)) {
+    result.status = CaseResult::NO_REFERENCE;
+    return result;
+  }
+  result.reference_frames = reference.left.size();
+  if (reference.left.size() != actual.left.size()) {
+    result.status = CaseResult::LENGTH_MISMATCH;
+    return result;
+  }
+
+  const std::vector<float> *channels[][2] = {
+      {&reference.left, &actual.left}, {&reference.right, &actual.right}};
+  for (const auto &channel : channels) {
+    const std::vector<float> &ref = *channel[0];
+    const std::vector<float> &act = *channel[1];
+    for (size_t i = 0; i < ref.size(); i++) {
+      result.max_abs_error =
+          std::max(result.max_abs_error,
+                   static_cast<double>(std::abs(act[i] - ref[i])));
+    }
+    result.spectral_db = std::max(
+        result.spectral_db,
+        host::SpectralDeviationDb(
+            host::ThirdOctaveSpectrum(ref.data(), ref.size(),
+                                      kEngineSampleRate),
+            host::ThirdOctaveSpectrum(act.data(), act.size(),
+                                      kEngineSampleRate)));
+  }
+
+  const Tolerance tolerance =
+      options.exact ? Tolerance{0., 0.} : c.tolerance;
+  const bool ok = result.max_abs_error <= tolerance.max_abs_error &&
+                  result.spectral_db <= tolerance.spectral_db;
+  result.status = ok ? CaseResult::OK : CaseResult::FAILED;
+  if (!ok) {
+    // Keep the failed render next to the reference for a listen or a diff.
+    WriteWav(ReferencePath(options, c, ".failed.wav"), actual);
+  }
+  return result;
+}
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s record|check|list [options]\n"
+          "\n"
+          "  record  Render every case and store it as the reference\n"
+          "  check   Render every case and compare it with its reference\n"
+          "  list    Print the cases and their tolerances\n"
+          "\n"
+          "options:\n"
+          "  --dir DIR      Where the references live (default: golden)\n"
+          "  --engine NAME  Only this engine (repeatable)\n"
+          "  --exact        Fail on any difference at all\n",
+          prog);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    usage(argv[0]);
+    return 2;
+  }
+  const std::string mode = argv[1];
+  if (mode != "record" && mode != "check" && mode != "list") {
+    usage(argv[0]);
+    return 2;
+  }
+  Options options;
+  options.record = mode == "record";
+  for (int i = 2; i < argc; i++) {
+    const char *arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--dir") == 0 && has_value) {
+      options.dir = argv[++i];
+    } else if (strcmp(arg, "--engine") == 0 && has_value) {
+      options.engines.push_back(argv[++i]);
+    } else if (strcmp(arg, "--exact") == 0) {
+      options.exact = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<Case> cases = AllCases();
+  for (const std::string &name : options.engines) {
+    if (std::none_of(cases.begin(), cases.end(),
+                     [&name](const Case &c) { return c.engine == name; })) {
+      fprintf(stderr, "unknown engine '%s'\n", name.c_str());
+      return 2;
+    }
+  }
+  if (!options.engines.empty()) {
+    cases.erase(std::remove_if(cases.begin(), cases.end(),
+                               [&options](const Case &c) {
+                                 return std::find(options.engines.begin(),
+                                                  options.engines.end(),
+                                                  c.engine) ==
+                                        options.engines.end();
+                               }),
+                cases.end());
+  }
+
+  if (mode == "list") {
+    for (const Case &c : cases) {
+      printf("%-32s max error %.0e, spectrum %.2f dB\n",
+             (c.engine + "/" + c.signal->name).c_str(),
+             c.tolerance.max_abs_error, c.tolerance.spectral_db);
+    }
+    return 0;
+  }
+
+  size_t failures = 0;
+  for (const Case &c : cases) {
+    const std::string name = c.engine + "/" + c.signal->name;
+    CaseResult r = {};
+    if (!host::RunForked([&c, &options] { return RunCase(c, options); },
+                         &r)) {
+      printf("%-32s CRASHED\n", name.c_str());
+      failures++;
+      continue;
+    }
+    switch (r.status) {
+      case CaseResult::OK:
+        if (options.record) {
+          printf("%-32s recorded %zu frames\n", name.c_str(), r.frames);
+        } else {
+          printf("%-32s ok      max error %.2e, spectrum %.3f dB\n",
+                 name.c_str(), r.max_abs_error, r.spectral_db);
+        }
+        break;
+      case CaseResult::FAILED:
+        printf("%-32s FAILED  max error %.2e (limit %.0e), "
+               "spectrum %.3f dB (limit %.2f)\n",
+               name.c_str(), r.max_abs_error, c.tolerance.max_abs_error,
+               r.spectral_db, c.tolerance.spectral_db);
+        break;
+      case CaseResult::NO_REFERENCE:
+        printf("%-32s MISSING %s\n", name.c_str(),
+               ReferencePath(options, c).c_str());
+        break;
+      case CaseResult::LENGTH_MISMATCH:
+        printf("%-32s FAILED  %zu frames, reference has %zu\n", name.c_str(),
+               r.frames, r.reference_frames);
+        break;
+      case CaseResult::IO_ERROR:
+        printf("%-32s FAILED  can't write %s\n", name.c_str(),
+               ReferencePath(options, c).c_str());
+        break;
+      case CaseResult::OUT_OF_MEMORY:
+        printf("%-32s FAILED  delays didn't fit in the arena\n",
+               name.c_str());
+        break;
+    }
+    if (r.status != CaseResult::OK) {
+      failures++;
+    }
+  }
+  if (failures > 0) {
+    printf("%zu of %zu cases failed\n", failures, cases.size());
+    return 1;
+  }
+  return 0;
+}
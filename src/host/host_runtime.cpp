@@ -0,0 +1,245 @@
+/*
+ * Host runtime for Hothouse DSP Platform effects
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "host_runtime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace host {
+
+// These mirror the pin assignments in hothouse.cpp (Daisy Seed "D" numbers).
+constexpr uint8_t kToggleUpPins[Runtime::kNumToggles] = {9, 7, 5};
+constexpr uint8_t kToggleDownPins[Runtime::kNumToggles] = {10, 8, 6};
+constexpr uint8_t kFootswitchPins[Runtime::kNumFootswitches] = {25, 26};
+constexpr uint8_t kLedPins[Runtime::kNumLeds] = {22, 23};
+
+Runtime &Runtime::Get() {
+  static Runtime runtime;
+  return runtime;
+}
+
+Runtime::Runtime() {
+  // Until told otherwise the knobs sit at noon and the toggles in the middle.
+  for (size_t i = 0; i < kNumKnobs; i++) {
+    SetKnob(i, 0.5f);
+  }
+}
+
+void Runtime::SetKnob(size_t knob, float value) {
+  if (knob >= kNumKnobs) {
+    return;
+  }
+  value = std::clamp(value, 0.f, 1.f);
+  adc_values_[knob] = static_cast<uint16_t>(std::lround(value * 65535.f));
+}
+
+float Runtime::Knob(size_t knob) const {
+  return knob < kNumKnobs ? adc_values_[knob] / 65535.f : 0.f;
+}
+
+void Runtime::SetToggle(size_t toggle, ToggleswitchPosition position) {
+  if (toggle >= kNumToggles) {
+    return;
+  }
+  pin_active_[kToggleUpPins[toggle]] = position == TOGGLE_UP;
+  pin_active_[kToggleDownPins[toggle]] = position == TOGGLE_DOWN;
+}
+
+void Runtime::SetFootswitch(size_t footswitch, bool down) {
+  if (footswitch >= kNumFootswitches) {
+    return;
+  }
+  pin_active_[kFootswitchPins[footswitch]] = down;
+}
+
+void Runtime::At(double seconds, std::function<void()> action) {
+  Event event = {static_cast<uint64_t>(std::llround(seconds * 1e6)),
+                 std::move(action)};
+  // Keep events sorted by time, and in insertion order for equal times.
+  auto pos = std::upper_bound(
+      events_.begin(), events_.end(), event.time_us,
+      [](uint64_t t, const Event &e) { return t < e.time_us; });
+  events_.insert(pos, std::move(event));
+}
+
+void Runtime::SetLed(uint8_t pin, float brightness) {
+  if (pin >= kNumPins) {
+    return;
+  }
+  // The firmware refreshes the LEDs on every callback, so only report changes.
+  if (led_listener_ && std::fabs(brightness - led_[pin]) > 1e-4f) {
+    for (size_t led = 0; led < kNumLeds; led++) {
+      if (kLedPins[led] == pin) {
+        led_listener_(led, brightness);
+      }
+    }
+  }
+  led_[pin] = brightness;
+}
+
+float Runtime::LedBrightness(size_t led) const {
+  return led < kNumLeds ? led_[kLedPins[led]] : 0.f;
+}
+
+void Runtime::ApplyDueEvents() {
+  // Actions may schedule further actions, so take them off one at a time.
+  while (!events_.empty() && events_.front().time_us <= now_us_) {
+    Event event = std::move(events_.front());
+    events_.erase(events_.begin());
+    event.action();
+  }
+}
+
+void Runtime::SetBlockSize(size_t size) {
+  block_size_ = block_size_override_ > 0 ? block_size_override_ : size;
+}
+
+void Runtime::StartAudio(daisy::AudioHandle::AudioCallback cb) {
+  callback_ = cb;
+  interleaved_callback_ = nullptr;
+  Start();
+}
+
+void Runtime::StartAudio(daisy::AudioHandle::InterleavingAudioCallback cb) {
+  callback_ = nullptr;
+  interleaved_callback_ = cb;
+  Start();
+}
+
+void Runtime::Start() {
+  if (running_) {
+    return;  // Just a callback change
+  }
+  if (source_ != nullptr && source_->SampleRate() != sample_rate_) {
+    throw std::runtime_error(
+        "input is " + std::to_string(source_->SampleRate()) +
+        " Hz but the firmware runs at " + std::to_string(sample_rate_) +
+        " Hz");
+  }
+  running_ = true;
+  audio_start_us_ = now_us_;
+  audio_frames_ = 0;
+}
+
+void Runtime::StopAudio() { running_ = false; }
+
+uint64_t Runtime::NextBlockUs() const {
+  return static_cast<uint64_t>(BlockStartUs());
+}
+
+double Runtime::BlockStartUs() const {
+  return static_cast<double>(audio_start_us_) +
+         static_cast<double>(audio_frames_) * 1e6 / sample_rate_;
+}
+
+void Runtime::Delay(uint64_t us) {
+  const uint64_t target = now_us_ + us;
+  while (running_ && NextBlockUs() <= target) {
+    now_us_ = NextBlockUs();
+    ApplyDueEvents();
+    RunBlock();
+  }
+  now_us_ = target;
+  ApplyDueEvents();
+
+  if (!running_ && now_us_ >= startup_timeout_us_) {
+    throw RenderFinished{false, "the firmware never started audio"};
+  }
+}
+
+void Runtime::RunBlock() {
+  const size_t size = block_size_;
+  if (in_left_.size() != size) {
+    in_left_.assign(size, 0.f);
+    in_right_.assign(size, 0.f);
+    out_left_.assign(size, 0.f);
+    out_right_.assign(size, 0.f);
+    in_interleaved_.assign(size * 2, 0.f);
+    out_interleaved_.assign(size * 2, 0.f);
+  }
+
+  size_t valid = 0;
+  if (!source_done_ && source_ != nullptr) {
+    valid = source_->Read(in_left_.data(), in_right_.data(), size);
+    if (valid < size) {
+      source_done_ = true;
+      tail_remaining_ = tail_frames_;
+    }
+  } else if (source_ == nullptr) {
+    source_done_ = true;
+  }
+  std::fill(in_left_.begin() + valid, in_left_.end(), 0.f);
+  std::fill(in_right_.begin() + valid, in_right_.end(), 0.f);
+
+  // Frames past the end of the input are still worth keeping while the tail
+  // rings out.
+  const size_t tail = std::min(size - valid, tail_remaining_);
+  tail_remaining_ -= tail;
+  const size_t keep = valid + tail;
+
+  // Only the callback itself is timed; on the pedal the DMA does the copying.
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point callback_start;
+  Clock::time_point callback_end;
+  if (interleaved_callback_ != nullptr) {
+    for (size_t i = 0; i < size; i++) {
+      in_interleaved_[i * 2] = in_left_[i];
+      in_interleaved_[i * 2 + 1] = in_right_[i];
+    }
+    callback_start = Clock::now();
+    interleaved_callback_(in_interleaved_.data(), out_interleaved_.data(),
+                          size * 2);
+    callback_end = Clock::now();
+    for (size_t i = 0; i < size; i++) {
+      out_left_[i] = out_interleaved_[i * 2];
+      out_right_[i] = out_interleaved_[i * 2 + 1];
+    }
+  } else if (callback_ != nullptr) {
+    const float *in[2] = {in_left_.data(), in_right_.data()};
+    float *out[2] = {out_left_.data(), out_right_.data()};
+    callback_start = Clock::now();
+    callback_(in, out, size);
+    callback_end = Clock::now();
+  }
+  timing_.Record(BlockStartUs(), static_cast<double>(size) * 1e6 / sample_rate_,
+                 std::chrono::duration<double, std::nano>(callback_end -
+                                                          callback_start)
+                     .count());
+
+  audio_frames_ += size;
+  callbacks_++;
+
+  if (sink_ != nullptr && keep > 0) {
+    sink_->Write(out_left_.data(), out_right_.data(), keep);
+  }
+  frames_rendered_ += keep;
+
+  if (source_done_ && tail_remaining_ == 0) {
+    running_ = false;
+    throw RenderFinished{true, "end of input"};
+  }
+}
+
+}  // namespace host
@@ -0,0 +1,221 @@
+/*
+ * Host runtime for Hothouse DSP Platform effects
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "daisy_seed.h"
+#include "sai_timing.h"
+
+namespace host {
+
+/// @brief Where the simulated codec reads its input from.
+class AudioSource {
+ public:
+  virtual ~AudioSource() = default;
+
+  /// @brief Fills up to `frames` frames of planar stereo audio.
+  /// @return The number of frames written. Returns 0 once exhausted.
+  virtual size_t Read(float *left, float *right, size_t frames) = 0;
+
+  virtual float SampleRate() const = 0;
+};
+
+/// @brief Where the simulated codec writes its output to.
+class AudioSink {
+ public:
+  virtual ~AudioSink() = default;
+  virtual void Write(const float *left, const float *right, size_t frames) = 0;
+};
+
+/// @brief Thrown out of the firmware's main loop when the render is over.
+///
+/// The firmware never returns from `main()`, so this is how the runtime hands
+/// control back to the host tool.
+struct RenderFinished {
+  bool complete;  // True when the input (and tail) ran out normally
+  const char *reason;
+};
+
+/// @brief Simulated hardware that the libDaisy stand-ins talk to.
+///
+/// Time only moves when the firmware waits (`System::Delay()`). Each wait runs
+/// however many audio callbacks fit into it, so a render goes as fast as the
+/// host CPU allows rather than in real time.
+class Runtime {
+ public:
+  static constexpr size_t kNumKnobs = 6;
+  static constexpr size_t kNumToggles = 3;
+  static constexpr size_t kNumFootswitches = 2;
+  static constexpr size_t kNumLeds = 2;
+  static constexpr size_t kNumPins = 33;
+
+  enum ToggleswitchPosition {
+    TOGGLE_UP,
+    TOGGLE_MIDDLE,
+    TOGGLE_DOWN,
+  };
+
+  static Runtime &Get();
+
+  //
+  // Configuration. Call these before starting the firmware.
+  //
+
+  void SetSource(AudioSource *source) { source_ = source; }
+  void SetSink(AudioSink *sink) { sink_ = sink; }
+
+  /// @brief Forces a block size regardless of what the firmware asks for.
+  /// @param size Frames per callback, or 0 to honour the firmware.
+  void SetBlockSizeOverride(size_t size) { block_size_override_ = size; }
+
+  /// @brief Renders this many frames of silence after the input runs out.
+  void SetTailFrames(size_t frames) { tail_frames_ = frames; }
+
+  /// @brief Gives up if the firmware has not started audio after this long.
+  void SetStartupTimeoutMs(uint32_t ms) { startup_timeout_us_ = ms * 1000ull; }
+
+  //
+  // Controls
+  //
+
+  /// @param knob 0-based knob index.
+  /// @param value Knob position from 0 to 1.
+  void SetKnob(size_t knob, float value);
+  float Knob(size_t knob) const;
+
+  /// @param toggle 0-based toggleswitch index.
+  void SetToggle(size_t toggle, ToggleswitchPosition position);
+
+  /// @param footswitch 0-based footswitch index.
+  /// @param down True while the footswitch is held.
+  void SetFootswitch(size_t footswitch, bool down);
+
+  /// @brief Runs `action` once simulated time reaches `seconds`. Actions that
+  /// are due are applied just before the next audio callback.
+  void At(double seconds, std::function<void()> action);
+
+  /// @param led 0-based LED index.
+  /// @return The brightness the firmware last set, from 0 to 1.
+  float LedBrightness(size_t led) const;
+
+  /// @brief Called whenever the firmware changes an LED's brightness.
+  using LedListener = std::function<void(size_t led, float brightness)>;
+  void SetLedListener(LedListener listener) {
+    led_listener_ = std::move(listener);
+  }
+
+  //
+  // Used by the libDaisy stand-ins
+  //
+
+  uint16_t *AdcValue(size_t channel) { return &adc_values_[channel]; }
+  bool PinActive(uint8_t pin) const {
+    return pin < kNumPins ? pin_active_[pin] : false;
+  }
+  void SetLed(uint8_t pin, float brightness);
+  float Led(uint8_t pin) const { return pin < kNumPins ? led_[pin] : 0.f; }
+
+  uint64_t NowUs() const { return now_us_; }
+
+  /// @brief Advances simulated time, running any audio callbacks that fall
+  /// inside the wait.
+  void Delay(uint64_t us);
+
+  void StartAudio(daisy::AudioHandle::AudioCallback cb);
+  void StartAudio(daisy::AudioHandle::InterleavingAudioCallback cb);
+  void StopAudio();
+
+  void SetSampleRate(float sample_rate) { sample_rate_ = sample_rate; }
+  float SampleRate() const { return sample_rate_; }
+  void SetBlockSize(size_t size);
+  size_t BlockSize() const { return block_size_; }
+
+  //
+  // Statistics
+  //
+
+  uint64_t FramesRendered() const { return frames_rendered_; }
+  uint64_t Callbacks() const { return callbacks_; }
+
+  /// @brief Deadline model for the audio callbacks. Set its CPU ratio before
+  /// starting the firmware.
+  SaiTimingModel &Timing() { return timing_; }
+
+ private:
+  Runtime();
+
+  struct Event {
+    uint64_t time_us;
+    std::function<void()> action;
+  };
+
+  void Start();
+  void ApplyDueEvents();
+  void RunBlock();
+  uint64_t NextBlockUs() const;
+  /// When the current block's interrupt fires, to a fraction of a
+  /// microsecond. now_us_ is that rounded down.
+  double BlockStartUs() const;
+
+  AudioSource *source_ = nullptr;
+  AudioSink *sink_ = nullptr;
+
+  daisy::AudioHandle::AudioCallback callback_ = nullptr;
+  daisy::AudioHandle::InterleavingAudioCallback interleaved_callback_ = nullptr;
+  bool running_ = false;
+
+  float sample_rate_ = 48000.f;
+  size_t block_size_ = 48;
+  size_t block_size_override_ = 0;
+  size_t tail_frames_ = 0;
+  uint64_t startup_timeout_us_ = 10000000;
+
+  uint64_t now_us_ = 0;
+  uint64_t audio_start_us_ = 0;
+  uint64_t audio_frames_ = 0;
+  uint64_t frames_rendered_ = 0;
+  uint64_t callbacks_ = 0;
+  bool source_done_ = false;
+  size_t tail_remaining_ = 0;
+
+  std::vector<Event> events_;
+  LedListener led_listener_;
+  SaiTimingModel timing_;
+
+  std::array<uint16_t, kNumKnobs> adc_values_{};
+  std::array<bool, kNumPins> pin_active_{};
+  std::array<float, kNumPins> led_{};
+
+  std::vector<float> in_left_, in_right_, out_left_, out_right_;
+  std::vector<float> in_interleaved_, out_interleaved_;
+};
+
+}  // namespace host
+
+#endif  // HOST_RUNTIME_H
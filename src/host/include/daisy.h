@@ -0,0 +1,3 @@
+// Host stand-in for libDaisy's umbrella header. See daisy_seed.h.
+#pragma once
+#include "daisy_seed.h"
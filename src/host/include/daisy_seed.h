@@ -0,0 +1,358 @@
+/*
+ * Host (Linux) stand-in for libDaisy
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// This header takes the place of libDaisy's daisy_seed.h when an effect is
+// built for the host. It mirrors the libDaisy signatures closely enough that
+// hothouse.cpp and the effect sources compile unmodified. Everything that
+// would touch hardware is routed to host::Runtime (see host_runtime.h), which
+// drives the audio callback from a file and simulates time.
+
+#pragma once
+#ifndef HOST_DAISY_SEED_H
+#define HOST_DAISY_SEED_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Memory section attributes have no meaning on the host.
+#define DSY_SDRAM_BSS
+#define DSY_SDRAM_DATA
+#define DSY_DTCMRAM
+#define DSY_DMA_BUFFER_SECTOR
+
+namespace daisy {
+
+enum GPIOPort {
+  PORTA,
+  PORTB,
+  PORTC,
+  PORTD,
+  PORTE,
+  PORTF,
+  PORTG,
+  PORTH,
+  PORTI,
+  PORTJ,
+  PORTK,
+  PORTX,
+};
+
+/** Host pins carry the Daisy Seed "D" number in `pin` so that the runtime can
+ * look up which switch or LED they belong to.
+ */
+struct Pin {
+  GPIOPort port;
+  uint8_t pin;
+
+  constexpr Pin() : port(PORTX), pin(255) {}
+  constexpr Pin(const GPIOPort pt, const uint8_t pn) : port(pt), pin(pn) {}
+
+  constexpr bool operator==(const Pin &rhs) const {
+    return (rhs.port == port) && (rhs.pin == pin);
+  }
+  constexpr bool operator!=(const Pin &rhs) const { return !operator==(rhs); }
+};
+
+namespace seed {
+constexpr Pin D0 = Pin(PORTX, 0);
+constexpr Pin D1 = Pin(PORTX, 1);
+constexpr Pin D2 = Pin(PORTX, 2);
+constexpr Pin D3 = Pin(PORTX, 3);
+constexpr Pin D4 = Pin(PORTX, 4);
+constexpr Pin D5 = Pin(PORTX, 5);
+constexpr Pin D6 = Pin(PORTX, 6);
+constexpr Pin D7 = Pin(PORTX, 7);
+constexpr Pin D8 = Pin(PORTX, 8);
+constexpr Pin D9 = Pin(PORTX, 9);
+constexpr Pin D10 = Pin(PORTX, 10);
+constexpr Pin D11 = Pin(PORTX, 11);
+constexpr Pin D12 = Pin(PORTX, 12);
+constexpr Pin D13 = Pin(PORTX, 13);
+constexpr Pin D14 = Pin(PORTX, 14);
+constexpr Pin D15 = Pin(PORTX, 15);
+constexpr Pin D16 = Pin(PORTX, 16);
+constexpr Pin D17 = Pin(PORTX, 17);
+constexpr Pin D18 = Pin(PORTX, 18);
+constexpr Pin D19 = Pin(PORTX, 19);
+constexpr Pin D20 = Pin(PORTX, 20);
+constexpr Pin D21 = Pin(PORTX, 21);
+constexpr Pin D22 = Pin(PORTX, 22);
+constexpr Pin D23 = Pin(PORTX, 23);
+constexpr Pin D24 = Pin(PORTX, 24);
+constexpr Pin D25 = Pin(PORTX, 25);
+constexpr Pin D26 = Pin(PORTX, 26);
+constexpr Pin D27 = Pin(PORTX, 27);
+constexpr Pin D28 = Pin(PORTX, 28);
+constexpr Pin D29 = Pin(PORTX, 29);
+constexpr Pin D30 = Pin(PORTX, 30);
+constexpr Pin D31 = Pin(PORTX, 31);
+constexpr Pin D32 = Pin(PORTX, 32);
+}  // namespace seed
+
+class System {
+ public:
+  /** Milliseconds of simulated time since boot. */
+  static uint32_t GetNow();
+
+  /** Microseconds of simulated time since boot. */
+  static uint32_t GetUs();
+
+  /** Blocking delay. On the host this is where audio gets rendered. */
+  static void Delay(uint32_t delay_ms);
+
+  static void DelayUs(uint32_t delay_us);
+
+  /** Ends the render; there is no bootloader on the host. */
+  static void ResetToBootloader();
+};
+
+class SaiHandle {
+ public:
+  struct Config {
+    enum class SampleRate {
+      SAI_8KHZ,
+      SAI_16KHZ,
+      SAI_32KHZ,
+      SAI_48KHZ,
+      SAI_96KHZ,
+    };
+  };
+};
+
+class AudioHandle {
+ public:
+  typedef const float *const *InputBuffer;
+  typedef float **OutputBuffer;
+  typedef void (*AudioCallback)(InputBuffer in, OutputBuffer out, size_t size);
+
+  typedef const float *InterleavingInputBuffer;
+  typedef float *InterleavingOutputBuffer;
+  typedef void (*InterleavingAudioCallback)(InterleavingInputBuffer in,
+                                            InterleavingOutputBuffer out,
+                                            size_t size);
+};
+
+struct AdcChannelConfig {
+  void InitSingle(Pin pin) { pin_ = pin; }
+  Pin pin_;
+};
+
+class AdcHandle {
+ public:
+  void Init(AdcChannelConfig *cfg, size_t num_channels);
+  void Start() {}
+  void Stop() {}
+
+  /** Returns a pointer to the raw 16-bit value of the channel. The values
+   * are owned by host::Runtime so that a render can move the knobs.
+   */
+  uint16_t *GetPtr(uint8_t chn);
+  uint16_t Get(uint8_t chn);
+  float GetFloat(uint8_t chn);
+
+ private:
+  size_t num_channels_ = 0;
+};
+
+class AnalogControl {
+ public:
+  AnalogControl() {}
+  ~AnalogControl() {}
+
+  void Init(uint16_t *adcptr, float sr, bool flip = false, bool invert = false,
+            float slew_seconds = 0.002f);
+
+  float Process();
+
+  inline float Value() const { return val_; }
+
+  void SetSampleRate(float sample_rate);
+
+  inline void SetCoeff(float val) {
+    coeff_ = val < 0.f ? 0.f : (val > 1.f ? 1.f : val);
+  }
+
+ private:
+  uint16_t *raw_ = nullptr;
+  float samplerate_ = 1000.f;
+  float coeff_ = 1.f;
+  float val_ = 0.f;
+  float slew_seconds_ = 0.002f;
+  bool flip_ = false;
+  bool invert_ = false;
+};
+
+class Switch {
+ public:
+  enum Type { TYPE_TOGGLE, TYPE_MOMENTARY };
+  enum Polarity { POLARITY_NORMAL, POLARITY_INVERTED };
+  enum Pull { PULL_UP, PULL_DOWN, PULL_NONE };
+
+  Switch() {}
+  ~Switch() {}
+
+  void Init(Pin pin, float update_rate, Type t, Polarity pol, Pull pu) {
+    Init(pin, update_rate);
+  }
+  void Init(Pin pin, float update_rate = 0.f);
+
+  /** Same debounce as libDaisy: shifts in one reading per millisecond. */
+  void Debounce();
+
+  inline bool RisingEdge() const { return updated_ ? state_ == 0x7f : false; }
+  inline bool FallingEdge() const { return updated_ ? state_ == 0x80 : false; }
+  inline bool Pressed() const { return state_ == 0xff; }
+  bool RawState();
+  inline float TimeHeldMs() const {
+    return Pressed() ? System::GetNow() - rising_edge_time_ : 0;
+  }
+
+ private:
+  Pin pin_;
+  uint32_t last_update_ = 0;
+  uint32_t rising_edge_time_ = 0;
+  uint8_t state_ = 0x00;
+  bool updated_ = false;
+};
+
+class Led {
+ public:
+  Led() {}
+  ~Led() {}
+
+  void Init(Pin pin, bool invert, float samplerate = 1000.0f);
+
+  /** Sets the brightness (0-1). Takes effect on the next Update(). */
+  void Set(float val);
+
+  /** Publishes the brightness to the runtime's LED state. */
+  void Update();
+
+ private:
+  Pin pin_;
+  float bright_ = 0.f;
+};
+
+class Parameter {
+ public:
+  enum Curve {
+    LINEAR,
+    EXPONENTIAL,
+    LOGARITHMIC,
+    CUBE,
+    LAST,
+  };
+
+  Parameter() {}
+  ~Parameter() {}
+
+  void Init(AnalogControl input, float min, float max, Curve curve);
+
+  float Process();
+
+  inline float Value() const { return val_; }
+
+ private:
+  AnalogControl in_;
+  float pmin_ = 0.f, pmax_ = 1.f;
+  float lmin_ = 0.f, lmax_ = 0.f;
+  float val_ = 0.f;
+  Curve pcurve_ = LINEAR;
+};
+
+class QSPIHandle {};
+
+/** Keeps settings in memory. Every render starts from a "fresh" flash, so the
+ * defaults passed to Init() are what the effect sees.
+ */
+template <typename SettingStruct>
+class PersistentStorage {
+ public:
+  enum class State {
+    UNKNOWN = 0,
+    FACTORY = 1,
+    USER = 2,
+  };
+
+  PersistentStorage(QSPIHandle &qspi) : qspi_(qspi), state_(State::UNKNOWN) {}
+
+  void Init(const SettingStruct &defaults, uint32_t address_offset = 0) {
+    default_settings_ = defaults;
+    settings_ = defaults;
+    state_ = State::FACTORY;
+  }
+
+  State GetState() const { return state_; }
+
+  SettingStruct &GetSettings() { return settings_; }
+
+  void Save() { state_ = State::USER; }
+
+  void RestoreDefaults() {
+    settings_ = default_settings_;
+    state_ = State::FACTORY;
+  }
+
+ private:
+  QSPIHandle &qspi_;
+  SettingStruct default_settings_;
+  SettingStruct settings_;
+  State state_;
+};
+
+class DaisySeed {
+ public:
+  DaisySeed() {}
+  ~DaisySeed() {}
+
+  void Configure() {}
+  void Init(bool boost = false) {}
+
+  void DelayMs(size_t del) { System::Delay(del); }
+
+  Pin GetPin(uint8_t pin_idx) { return Pin(PORTX, pin_idx); }
+
+  void StartAudio(AudioHandle::InterleavingAudioCallback cb);
+  void StartAudio(AudioHandle::AudioCallback cb);
+  void ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb);
+  void ChangeAudioCallback(AudioHandle::AudioCallback cb);
+  void StopAudio();
+
+  void SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate);
+  float AudioSampleRate();
+  void SetAudioBlockSize(size_t blocksize);
+  size_t AudioBlockSize();
+  float AudioCallbackRate() const;
+
+  /** Printed to stderr so that it does not mix with tool output. */
+  static void PrintLine(const char *format, ...);
+  static void Print(const char *format, ...);
+  static void StartLog(bool wait_for_pc = false) {}
+
+  AdcHandle adc;
+  QSPIHandle qspi;
+};
+
+}  // namespace daisy
+
+#endif  // HOST_DAISY_SEED_H
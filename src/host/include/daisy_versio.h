@@ -0,0 +1,4 @@
+// Host stand-in for libDaisy's daisy_versio.h, which PlateauNEVersio's
+// Utilities.hpp includes. Nothing Versio-specific is used by the plate.
+#pragma once
+#include "daisy_seed.h"
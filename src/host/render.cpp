@@ -0,0 +1,233 @@
+/*
+ * Offline renderer for Hothouse DSP Platform effects
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// Streams a WAV file through an effect's real AudioCallback. Each render_xyz
+// binary links one effect's firmware source (with its main() renamed to
+// hothouse_effect_main) against the host stand-in for libDaisy.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "control_script.h"
+#include "host_runtime.h"
+#include "load_meter.h"
+#include "wav_file.h"
+
+using host::ControlScript;
+using host::Runtime;
+using host::WavReader;
+using host::WavWriter;
+
+/// The firmware's main(), renamed by the Makefile.
+int hothouse_effect_main();
+
+constexpr double kPedalHz = 480e6;
+
+/// Clock for the firmware's load meter that counts the cycles the pedal would
+/// have taken, going by --cpu-ratio.
+static uint32_t PedalCycles() {
+  const double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  const double cycles =
+      ns * 1e-9 * kPedalHz * Runtime::Get().Timing().CpuRatio();
+  return static_cast<uint32_t>(static_cast<uint64_t>(cycles));
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [options] input.wav output.wav\n"
+          "\n"
+          "options:\n"
+          "  --block N        Force the audio block size (default: whatever "
+          "the firmware sets)\n"
+          "  --tail SECONDS   Keep rendering this long after the input ends "
+          "(default: 0)\n"
+          "  --knob N=VALUE   Set knob N (1-6) to VALUE (0-1). Default 0.5\n"
+          "  --toggle N=POS   Set toggleswitch N (1-3) to up, middle or down\n"
+          "  --press N@SECS   Tap footswitch N (1-2) at SECS seconds\n"
+          "  --script FILE    Run the timestamped control script in FILE\n"
+          "  --event LINE     Run a single control script line\n"
+          "  --led-log FILE   Write every LED change to FILE as CSV\n"
+          "  --cpu-ratio R    How many times slower the pedal is than this "
+          "machine,\n"
+          "                   used to check the audio deadlines (default: 1)\n"
+          "  --strict         Fail if a deadline is missed\n"
+          "  --pcm16          Write 16-bit PCM (default: 32-bit float)\n"
+          "  --pcm24          Write 24-bit PCM\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  Runtime &rt = Runtime::Get();
+  ControlScript script(rt);
+  WavWriter::Format format = WavWriter::Format::FLOAT32;
+  double tail_seconds = 0.;
+  bool strict = false;
+  const char *led_log_path = nullptr;
+  const char *input_path = nullptr;
+  const char *output_path = nullptr;
+  std::string error;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    int n = 0;
+    float value = 0.f;
+    char text[16] = {0};
+    // The shorthand options are turned into script lines so that they are
+    // checked and scheduled the same way.
+    std::string line;
+    if (strcmp(arg, "--block") == 0 && has_value) {
+      rt.SetBlockSizeOverride(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(arg, "--tail") == 0 && has_value) {
+      tail_seconds = atof(argv[++i]);
+    } else if (strcmp(arg, "--knob") == 0 && has_value &&
+               sscanf(argv[++i], "%d=%f", &n, &value) == 2) {
+      line = "0 knob " + std::to_string(n) + " " + std::to_string(value);
+    } else if (strcmp(arg, "--toggle") == 0 && has_value &&
+               sscanf(argv[++i], "%d=%15s", &n, text) == 2) {
+      line = "0 toggle " + std::to_string(n) + " " + text;
+    } else if (strcmp(arg, "--press") == 0 && has_value &&
+               sscanf(argv[++i], "%d@%f", &n, &value) == 2) {
+      line = std::to_string(value) + " footswitch " + std::to_string(n) +
+             " tap";
+    } else if (strcmp(arg, "--script") == 0 && has_value) {
+      if (!script.Load(argv[++i], &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+      }
+    } else if (strcmp(arg, "--event") == 0 && has_value) {
+      line = argv[++i];
+    } else if (strcmp(arg, "--led-log") == 0 && has_value) {
+      led_log_path = argv[++i];
+    } else if (strcmp(arg, "--cpu-ratio") == 0 && has_value) {
+      rt.Timing().SetCpuRatio(atof(argv[++i]));
+    } else if (strcmp(arg, "--strict") == 0) {
+      strict = true;
+    } else if (strcmp(arg, "--pcm16") == 0) {
+      format = WavWriter::Format::PCM16;
+    } else if (strcmp(arg, "--pcm24") == 0) {
+      format = WavWriter::Format::PCM24;
+    } else if (arg[0] != '-' && input_path == nullptr) {
+      input_path = arg;
+    } else if (arg[0] != '-' && output_path == nullptr) {
+      output_path = arg;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+    if (!line.empty() && !script.AddLine(line, &error)) {
+      fprintf(stderr, "%s: %s\n", arg, error.c_str());
+      return 2;
+    }
+  }
+  if (input_path == nullptr || output_path == nullptr) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  clevelandmusicco::LoadMeter::SetClock(PedalCycles,
+                                        static_cast<float>(kPedalHz));
+
+  FILE *led_log = nullptr;
+  if (led_log_path != nullptr) {
+    led_log = fopen(led_log_path, "w");
+    if (led_log == nullptr) {
+      fprintf(stderr, "can't create %s\n", led_log_path);
+      return 1;
+    }
+    fprintf(led_log, "seconds,led,brightness\n");
+    rt.SetLedListener([&rt, led_log](size_t led, float brightness) {
+      fprintf(led_log, "%.6f,%zu,%.3f\n", rt.NowUs() * 1e-6, led + 1,
+              brightness);
+    });
+  }
+
+  WavReader reader;
+  if (!reader.Open(input_path, &error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+  WavWriter writer;
+  if (!writer.Open(output_path, reader.SampleRate(), format)) {
+    fprintf(stderr, "can't create %s\n", output_path);
+    return 1;
+  }
+
+  rt.SetSource(&reader);
+  rt.SetSink(&writer);
+  rt.SetTailFrames(static_cast<size_t>(tail_seconds * reader.SampleRate()));
+
+  const auto start = std::chrono::steady_clock::now();
+  int status = 0;
+  try {
+    hothouse_effect_main();
+    fprintf(stderr, "firmware main() returned\n");
+  } catch (const host::RenderFinished &finished) {
+    if (!finished.complete) {
+      fprintf(stderr, "render stopped early: %s\n", finished.reason);
+      status = 1;
+    }
+  } catch (const std::exception &e) {
+    fprintf(stderr, "render failed: %s\n", e.what());
+    status = 1;
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (!writer.Close()) {
+    fprintf(stderr, "error writing %s\n", output_path);
+    return 1;
+  }
+
+  if (led_log != nullptr) {
+    fclose(led_log);
+  }
+
+  const double audio_seconds = rt.FramesRendered() / rt.SampleRate();
+  fprintf(stderr,
+          "rendered %.2f s in %.2f s (%.1fx realtime), %llu callbacks of "
+          "%zu frames\n",
+          audio_seconds, elapsed.count(),
+          elapsed.count() > 0 ? audio_seconds / elapsed.count() : 0.,
+          static_cast<unsigned long long>(rt.Callbacks()), rt.BlockSize());
+  rt.Timing().Report(stderr);
+  if (strict && rt.Timing().MissedDeadlines() > 0) {
+    status = 1;
+  }
+
+  for (const std::string &failure : script.Failures()) {
+    fprintf(stderr, "%s\n", failure.c_str());
+  }
+  if (script.Checks() > 0) {
+    fprintf(stderr, "%zu of %zu LED checks passed\n",
+            script.Checks() - script.Failures().size(), script.Checks());
+  }
+  if (!script.Failures().empty()) {
+    status = 1;
+  }
+  return status;
+}
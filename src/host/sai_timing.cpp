@@ -0,0 +1,86 @@
+/*
+ * SAI/DMA deadline model for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "sai_timing.h"
+
+#include <algorithm>
+
+namespace host {
+
+void SaiTimingModel::Record(double irq_us, double period_us, double host_ns) {
+  const double cost_us = host_ns * 1e-3 * cpu_ratio_;
+  // A callback that overran delays the one after it, since the interrupt
+  // stays pending until the CPU gets back to it.
+  const double start_us = std::max(irq_us, cpu_free_us_);
+  const double finish_us = start_us + cost_us;
+  cpu_free_us_ = finish_us;
+
+  total_host_ns_ += host_ns;
+  worst_host_ns_ = std::max(worst_host_ns_, host_ns);
+
+  const double load = cost_us / period_us;
+  load_sum_ += load;
+  if (load > peak_load_) {
+    peak_load_ = load;
+    peak_load_us_ = irq_us;
+  }
+  const bool missed = finish_us > irq_us + period_us;
+  if (missed) {
+    if (!last_missed_) {
+      runs_++;
+      if (missed_runs_.size() < kMaxRunsLogged) {
+        missed_runs_.push_back({irq_us, irq_us, 0});
+      }
+    }
+    if (runs_ <= kMaxRunsLogged) {
+      missed_runs_.back().last_us = irq_us;
+      missed_runs_.back().count++;
+    }
+    misses_++;
+  }
+  last_missed_ = missed;
+  callbacks_++;
+}
+
+void SaiTimingModel::Reset() {
+  const double cpu_ratio = cpu_ratio_;
+  *this = SaiTimingModel();
+  cpu_ratio_ = cpu_ratio;
+}
+
+void SaiTimingModel::Report(FILE *out) const {
+  fprintf(out,
+          "audio load at %.2fx host time: %.1f%% average, %.1f%% peak (at "
+          "%.3f s), %llu of %llu deadlines missed\n",
+          cpu_ratio_, AverageLoad() * 100., peak_load_ * 100.,
+          peak_load_us_ * 1e-6, static_cast<unsigned long long>(misses_),
+          static_cast<unsigned long long>(callbacks_));
+  for (const MissedRun &run : missed_runs_) {
+    fprintf(out, "  %.6f s to %.6f s: %llu late\n", run.first_us * 1e-6,
+            run.last_us * 1e-6, static_cast<unsigned long long>(run.count));
+  }
+  if (runs_ > missed_runs_.size()) {
+    fprintf(out, "  ... and %llu more runs\n",
+            static_cast<unsigned long long>(runs_ - missed_runs_.size()));
+  }
+}
+
+}  // namespace host
@@ -0,0 +1,110 @@
+/*
+ * SAI/DMA deadline model for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_SAI_TIMING_H
+#define HOST_SAI_TIMING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace host {
+
+/// @brief Models the deadlines of the Daisy's double-buffered SAI DMA.
+///
+/// On the pedal the DMA streams one half of a two-block buffer to the codec
+/// while the audio callback fills the other half. The half-transfer (or
+/// transfer-complete) interrupt that starts a callback fires once per block,
+/// and the callback has to be done before the DMA wraps around to the half it
+/// is writing, i.e. one block period later. If it is late the codec plays
+/// whatever was left in that half, and the next callback starts late too.
+///
+/// The host measures how long each callback takes and multiplies it by the
+/// CPU ratio (how many times slower the pedal is than this machine) to get
+/// the time the callback would have taken on the pedal.
+class SaiTimingModel {
+ public:
+  /// @brief A stretch of consecutive callbacks that all missed.
+  struct MissedRun {
+    double first_us;  // Interrupt time of the first late callback
+    double last_us;   // ...and of the last one
+    uint64_t count;
+  };
+
+  /// At most this many runs of missed deadlines are kept.
+  static constexpr size_t kMaxRunsLogged = 16;
+
+  /// @param ratio Time on the pedal divided by time on the host.
+  void SetCpuRatio(double ratio) { cpu_ratio_ = ratio > 0. ? ratio : 1.; }
+  double CpuRatio() const { return cpu_ratio_; }
+
+  /// @brief Records one callback.
+  /// @param irq_us Simulated time at which the DMA interrupt fired. Not
+  /// rounded to whole microseconds, which at small blocks is a good part of
+  /// the period (a block of 1 is 20.8 us at 48 kHz).
+  /// @param period_us Length of one block.
+  /// @param host_ns How long the callback took on the host.
+  void Record(double irq_us, double period_us, double host_ns);
+
+  /// @brief Forgets the callbacks recorded so far, e.g. after a warm-up. The
+  /// CPU ratio is kept.
+  void Reset();
+
+  uint64_t Callbacks() const { return callbacks_; }
+  uint64_t MissedDeadlines() const { return misses_; }
+
+  /// @brief The callback's share of the block period, as a fraction.
+  double AverageLoad() const {
+    return callbacks_ > 0 ? load_sum_ / static_cast<double>(callbacks_) : 0.;
+  }
+  double PeakLoad() const { return peak_load_; }
+  double PeakLoadUs() const { return peak_load_us_; }
+
+  /// @brief Time spent in callbacks on the host, unscaled.
+  double TotalHostNs() const { return total_host_ns_; }
+  double WorstHostNs() const { return worst_host_ns_; }
+
+  /// @brief The first runs of missed deadlines.
+  const std::vector<MissedRun> &MissedRuns() const { return missed_runs_; }
+
+  /// @brief Prints a summary of the loads and missed deadlines.
+  void Report(FILE *out) const;
+
+ private:
+  double cpu_ratio_ = 1.;
+  double cpu_free_us_ = 0.;  // When the pedal's CPU finishes the last callback
+  uint64_t callbacks_ = 0;
+  uint64_t misses_ = 0;
+  double load_sum_ = 0.;
+  double peak_load_ = 0.;
+  double peak_load_us_ = 0.;
+  double total_host_ns_ = 0.;
+  double worst_host_ns_ = 0.;
+  bool last_missed_ = false;
+  uint64_t runs_ = 0;
+  std::vector<MissedRun> missed_runs_;
+};
+
+}  // namespace host
+
+#endif  // HOST_SAI_TIMING_H
@@ -0,0 +1,388 @@
+/*
+ * Parameter sweeps of the Hothouse reverb engines
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// Renders an engine over a grid (or a random sample) of its parameters and
+// measures each setting's decay, brightness and level, so the interesting
+// corners of a reverb's parameter space can be found without listening to
+// every one of them. The results are CSV with one row per setting.
+//
+// Settings are spread over all cores by a work-stealing scheduler (see
+// RunWorkStealing()). Every job builds its own engine with
+// EngineMemory::kPrivate, so no two threads ever touch the same delay line.
+// --repeat runs every setting twice at once and checks that both runs agree,
+// which they can't if anything is still shared between engines.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analysis.h"
+#include "dsp/delays/DelayArena.hpp"
+#include "engines.h"
+#include "work_stealing.h"
+
+using host::Engine;
+using host::EngineMemory;
+using host::EngineParameter;
+using host::kEngineSampleRate;
+
+namespace {
+
+// The block size most of the effects use.
+constexpr size_t kBlockSize = 48;
+
+// Steps across a parameter's range when a sweep doesn't give a count.
+constexpr size_t kDefaultSteps = 5;
+
+// Length of the noise burst excitation.
+constexpr double kBurstSeconds = 0.05;
+
+/// How one parameter is swept: a fixed value, evenly spaced steps across a
+/// range, or (with --random) uniformly drawn from the range.
+struct Sweep {
+  size_t parameter;
+  float min;
+  float max;
+  size_t steps;  // 1 for a fixed value
+};
+
+struct Options {
+  std::string engine;
+  std::vector<std::string> params;
+  size_t random = 0;  // 0 means sweep the grid
+  unsigned seed = 1;
+  bool burst = false;
+  double seconds = 4.;
+  size_t threads = std::thread::hardware_concurrency();
+  const char *output_path = nullptr;
+  bool repeat = false;
+};
+
+struct Metrics {
+  double rt60_s;
+  double centroid_hz;
+  double peak_db;
+};
+
+/// Parses NAME, NAME=VALUE or NAME=MIN:MAX[:STEPS] against the engine's
+/// parameters. A bare NAME sweeps the parameter's whole range.
+bool ParseSweep(const std::string &spec,
+                const std::vector<EngineParameter> &parameters, Sweep *sweep) {
+  const size_t equals = spec.find('=');
+  const std::string name = spec.substr(0, equals);
+  size_t index = 0;
+  while (index < parameters.size() && name != parameters[index].name) {
+    index++;
+  }
+  if (index == parameters.size()) {
+    fprintf(stderr, "unknown parameter '%s'\n", name.c_str());
+    return false;
+  }
+  *sweep = {index, parameters[index].min, parameters[index].max,
+            kDefaultSteps};
+  if (equals == std::string::npos) {
+    return true;
+  }
+  const char *value = spec.c_str() + equals + 1;
+  char *end = nullptr;
+  sweep->min = sweep->max = strtof(value, &end);
+  sweep->steps = 1;
+  if (*end == ':') {
+    sweep->max = strtof(end + 1, &end);
+    sweep->steps = kDefaultSteps;
+    if (*end == ':') {
+      sweep->steps = strtoul(end + 1, &end, 10);
+    }
+  }
+  if (*end != '\0' || end == value || sweep->steps == 0) {
+    fprintf(stderr, "can't parse '%s'\n", spec.c_str());
+    return false;
+  }
+  return true;
+}
+
+/// Every parameter's value for each job. Parameters that aren't swept keep
+/// their fallbacks.
+std::vector<std::vector<float>> MakeJobs(
+    const std::vector<EngineParameter> &parameters,
+    const std::vector<Sweep> &sweeps, const Options &options) {
+  std::vector<float> fallbacks;
+  for (const EngineParameter &parameter : parameters) {
+    fallbacks.push_back(parameter.fallback);
+  }
+
+  std::vector<std::vector<float>> jobs;
+  if (options.random > 0) {
+    std::mt19937 random(options.seed);
+    for (size_t job = 0; job < options.random; job++) {
+      std::vector<float> values = fallbacks;
+      for (const Sweep &sweep : sweeps) {
+        std::uniform_real_distribution<float> range(sweep.min, sweep.max);
+        values[sweep.parameter] =
+            sweep.steps == 1 ? sweep.min : range(random);
+      }
+      jobs.push_back(values);
+    }
+    return jobs;
+  }
+
+  // The grid, with the last sweep changing fastest.
+  jobs.push_back(fallbacks);
+  for (const Sweep &sweep : sweeps) {
+    std::vector<std::vector<float>> grid;
+    for (const std::vector<float> &job : jobs) {
+      for (size_t step = 0; step < sweep.steps; step++) {
+        std::vector<float> values = job;
+        values[sweep.parameter] =
+            sweep.steps == 1
+                ? sweep.min
+                : sweep.min + (sweep.max - sweep.min) * step /
+                                  static_cast<float>(sweep.steps - 1);
+        grid.push_back(values);
+      }
+    }
+    jobs.swap(grid);
+  }
+  return jobs;
+}
+
+/// The excitation: a single full-scale sample, or a short burst of noise.
+std::vector<float> MakeExcitation(bool burst) {
+  if (!burst) {
+    return {1.f};
+  }
+  std::vector<float> signal(
+      static_cast<size_t>(kBurstSeconds * kEngineSampleRate));
+  uint32_t seed = 1;
+  for (float &sample : signal) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = 0.5f * (static_cast<float>(seed >> 8) / 8388608.f - 1.f);
+  }
+  return signal;
+}
+
+/// Renders one setting and measures the tail after the excitation ends.
+bool RunJob(const Options &options, const std::vector<float> &values,
+            const std::vector<float> &excitation, Metrics *metrics) {
+  std::unique_ptr<Engine> engine =
+      host::MakeEngine(options.engine, EngineMemory::kPrivate);
+  if (!engine || !engine->MemoryFits()) {
+    return false;
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    engine->SetParameter(i, values[i]);
+  }
+
+  const size_t frames =
+      static_cast<size_t>(options.seconds * kEngineSampleRate);
+  std::vector<float> in(frames, 0.f);
+  std::copy(excitation.begin(),
+            excitation.begin() + std::min(excitation.size(), frames),
+            in.begin());
+  std::vector<float> left(frames), right(frames);
+  for (size_t frame = 0; frame < frames; frame += kBlockSize) {
+    const size_t size = std::min(kBlockSize, frames - frame);
+    engine->Process(&in[frame], &in[frame], &left[frame], &right[frame],
+                    size);
+  }
+
+  const size_t start = std::min(excitation.size(), frames);
+  std::vector<float> tail(frames - start);
+  for (size_t i = 0; i < tail.size(); i++) {
+    tail[i] = (left[start + i] + right[start + i]) * 0.5f;
+  }
+  metrics->rt60_s =
+      host::Rt60Seconds(tail.data(), tail.size(), kEngineSampleRate);
+  metrics->centroid_hz =
+      host::SpectralCentroidHz(tail.data(), tail.size(), kEngineSampleRate);
+  metrics->peak_db = host::PeakDb(tail.data(), tail.size());
+  return true;
+}
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s --engine NAME [options]\n"
+          "\n"
+          "options:\n"
+          "  --engine NAME         Engine to sweep\n"
+          "  --param SPEC          Sweep a parameter (repeatable). SPEC is "
+          "NAME for its\n"
+          "                        whole range, NAME=VALUE, or "
+          "NAME=MIN:MAX[:STEPS]\n"
+          "                        (default: %zu steps)\n"
+          "  --random N            Draw N random settings from the ranges "
+          "instead of\n"
+          "                        sweeping the grid\n"
+          "  --seed N              Seed for --random (default: 1)\n"
+          "  --signal impulse|burst  Excitation (default: impulse)\n"
+          "  --seconds S           Render S seconds per setting "
+          "(default: 4)\n"
+          "  --threads N           Worker threads (default: one per core)\n"
+          "  --output FILE         Write the CSV here instead of stdout\n"
+          "  --repeat              Run every setting twice and fail if the "
+          "two runs\n"
+          "                        differ\n"
+          "\n"
+          "engines and parameters:\n",
+          prog, kDefaultSteps);
+  for (const std::string &name : host::EngineNames()) {
+    const std::unique_ptr<Engine> engine =
+        host::MakeEngine(name, EngineMemory::kPrivate);
+    if (engine->Parameters().empty()) {
+      continue;
+    }
+    fprintf(stderr, "  %s:", name.c_str());
+    for (const EngineParameter &parameter : engine->Parameters()) {
+      fprintf(stderr, " %s (%g-%g)", parameter.name, parameter.min,
+              parameter.max);
+    }
+    fprintf(stderr, "\n");
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--engine") == 0 && has_value) {
+      options.engine = argv[++i];
+    } else if (strcmp(arg, "--param") == 0 && has_value) {
+      options.params.push_back(argv[++i]);
+    } else if (strcmp(arg, "--random") == 0 && has_value) {
+      options.random = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--seed") == 0 && has_value) {
+      options.seed = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--signal") == 0 && has_value) {
+      const char *signal = argv[++i];
+      if (strcmp(signal, "burst") != 0 && strcmp(signal, "impulse") != 0) {
+        usage(argv[0]);
+        return 2;
+      }
+      options.burst = strcmp(signal, "burst") == 0;
+    } else if (strcmp(arg, "--seconds") == 0 && has_value) {
+      options.seconds = atof(argv[++i]);
+    } else if (strcmp(arg, "--threads") == 0 && has_value) {
+      options.threads = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--output") == 0 && has_value) {
+      options.output_path = argv[++i];
+    } else if (strcmp(arg, "--repeat") == 0) {
+      options.repeat = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  const std::unique_ptr<Engine> prototype =
+      host::MakeEngine(options.engine, EngineMemory::kPrivate);
+  if (!prototype || prototype->Parameters().empty()) {
+    fprintf(stderr, "'%s' isn't an engine with parameters\n",
+            options.engine.c_str());
+    usage(argv[0]);
+    return 2;
+  }
+  const std::vector<EngineParameter> &parameters = prototype->Parameters();
+  std::vector<Sweep> sweeps;
+  for (const std::string &spec : options.params) {
+    Sweep sweep;
+    if (!ParseSweep(spec, parameters, &sweep)) {
+      return 2;
+    }
+    sweeps.push_back(sweep);
+  }
+
+  const std::vector<std::vector<float>> jobs =
+      MakeJobs(parameters, sweeps, options);
+  const std::vector<float> excitation = MakeExcitation(options.burst);
+  // With --repeat, run i + jobs.size() is job i again.
+  const size_t runs = options.repeat ? 2 * jobs.size() : jobs.size();
+  std::vector<Metrics> results(runs);
+  std::vector<char> ok(runs, 0);
+
+  const auto started = std::chrono::steady_clock::now();
+  host::RunWorkStealing(runs, options.threads,
+                        [&](size_t run, size_t /* worker */) {
+                          ok[run] = RunJob(options, jobs[run % jobs.size()],
+                                           excitation, &results[run]);
+                        });
+  const double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - started)
+                             .count();
+
+  FILE *out = stdout;
+  if (options.output_path != nullptr) {
+    out = fopen(options.output_path, "w");
+    if (out == nullptr) {
+      fprintf(stderr, "can't write %s\n", options.output_path);
+      return 1;
+    }
+  }
+  fprintf(out, "job");
+  for (const EngineParameter &parameter : parameters) {
+    fprintf(out, ",%s", parameter.name);
+  }
+  fprintf(out, ",rt60_s,centroid_hz,peak_db\n");
+  int status = 0;
+  if (delayArena.failedCount() != 0) {
+    // Nothing in a sweep should be using the shared arena at all.
+    fprintf(stderr, "%zu delays didn't fit in the shared arena\n",
+            delayArena.failedCount());
+    status = 1;
+  }
+  for (size_t job = 0; job < jobs.size(); job++) {
+    if (!ok[job] || (options.repeat && !ok[job + jobs.size()])) {
+      fprintf(stderr, "job %zu failed\n", job);
+      status = 1;
+      continue;
+    }
+    if (options.repeat) {
+      const Metrics &again = results[job + jobs.size()];
+      if (memcmp(&again, &results[job], sizeof(Metrics)) != 0) {
+        fprintf(stderr, "job %zu came out differently the second time\n",
+                job);
+        status = 1;
+      }
+    }
+    fprintf(out, "%zu", job);
+    for (float value : jobs[job]) {
+      fprintf(out, ",%g", value);
+    }
+    fprintf(out, ",%.3f,%.1f,%.2f\n", results[job].rt60_s,
+            results[job].centroid_hz, results[job].peak_db);
+  }
+  if (out != stdout) {
+    fclose(out);
+  }
+  fprintf(stderr, "%zu settings in %.1f s\n", jobs.size(), elapsed);
+  return status;
+}
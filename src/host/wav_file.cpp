@@ -0,0 +1,330 @@
+/*
+ * WAV file streaming for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "wav_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace host {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+static uint16_t ReadU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t ReadU32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+//
+// WavReader
+//
+
+WavReader::~WavReader() {
+  if (map_ != nullptr) {
+    munmap(map_, map_size_);
+  }
+}
+
+bool WavReader::Open(const char *path, std::string *error) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    *error = std::string("can't open ") + path + ": " + strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 12) {
+    close(fd);
+    *error = std::string(path) + " is not a WAV file";
+    return false;
+  }
+  map_size_ = static_cast<size_t>(st.st_size);
+  map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    *error = std::string("can't map ") + path + ": " + strerror(errno);
+    return false;
+  }
+  madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+  const uint8_t *bytes = static_cast<const uint8_t *>(map_);
+  if (memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+    *error = std::string(path) + " is not a RIFF/WAVE file";
+    return false;
+  }
+
+  uint16_t format = 0;
+  uint16_t bits = 0;
+  bool have_fmt = false;
+  size_t data_size = 0;
+  size_t offset = 12;
+  while (offset + 8 <= map_size_) {
+    const uint8_t *chunk = bytes + offset;
+    size_t chunk_size = ReadU32(chunk + 4);
+    const uint8_t *body = chunk + 8;
+    const bool is_data = memcmp(chunk, "data", 4) == 0;
+    // Only the data chunk may run past the end of the file (see below).
+    if (!is_data && chunk_size > map_size_ - (offset + 8)) {
+      *error = std::string(path) + " is not a WAV file";
+      return false;
+    }
+    if (memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+      format = ReadU16(body);
+      channels_ = ReadU16(body + 2);
+      sample_rate_ = static_cast<float>(ReadU32(body + 4));
+      bits = ReadU16(body + 14);
+      if (format == kFormatExtensible && chunk_size >= 26) {
+        format = ReadU16(body + 24);  // First two bytes of the sub-format GUID
+      }
+      have_fmt = true;
+    } else if (is_data) {
+      data_ = body;
+      // Tolerate truncated files and streaming writers that left the size 0.
+      data_size = std::min(chunk_size, map_size_ - (offset + 8));
+      if (chunk_size == 0) {
+        data_size = map_size_ - (offset + 8);
+      }
+      break;
+    }
+    offset += 8 + chunk_size + (chunk_size & 1);
+  }
+
+  if (!have_fmt || data_ == nullptr || channels_ == 0) {
+    *error = std::string(path) + " is missing its fmt or data chunk";
+    return false;
+  }
+  if (format == kFormatPcm && bits == 16) {
+    encoding_ = Encoding::PCM16;
+  } else if (format == kFormatPcm && bits == 24) {
+    encoding_ = Encoding::PCM24;
+  } else if (format == kFormatPcm && bits == 32) {
+    encoding_ = Encoding::PCM32;
+  } else if (format == kFormatFloat && bits == 32) {
+    encoding_ = Encoding::FLOAT32;
+  } else {
+    *error = std::string(path) + " uses an unsupported sample format (" +
+             std::to_string(bits) + "-bit, format " + std::to_string(format) +
+             ")";
+    return false;
+  }
+  sample_bytes_ = bits / 8;
+  frame_bytes_ = sample_bytes_ * channels_;
+  frames_ = data_size / frame_bytes_;
+  position_ = 0;
+  return true;
+}
+
+float WavReader::Sample(const uint8_t *p) const {
+  switch (encoding_) {
+    case Encoding::PCM16:
+      return static_cast<int16_t>(ReadU16(p)) * (1.f / 32768.f);
+    case Encoding::PCM24: {
+      int32_t v = static_cast<int32_t>(p[0] << 8 | p[1] << 16 |
+                                       static_cast<uint32_t>(p[2]) << 24);
+      return static_cast<float>(v >> 8) * (1.f / 8388608.f);
+    }
+    case Encoding::PCM32:
+      return static_cast<float>(static_cast<int32_t>(ReadU32(p))) *
+             (1.f / 2147483648.f);
+    case Encoding::FLOAT32: {
+      float f;
+      memcpy(&f, p, sizeof(f));
+      return f;
+    }
+  }
+  return 0.f;
+}
+
+size_t WavReader::Read(float *left, float *right, size_t frames) {
+  const size_t n = std::min(frames, frames_ - position_);
+  const uint8_t *p = data_ + position_ * frame_bytes_;
+  const size_t right_offset = channels_ > 1 ? sample_bytes_ : 0;
+  for (size_t i = 0; i < n; i++, p += frame_bytes_) {
+    left[i] = Sample(p);
+    right[i] = Sample(p + right_offset);
+  }
+  position_ += n;
+  return n;
+}
+
+//
+// WavWriter
+//
+
+WavWriter::~WavWriter() { Close(); }
+
+bool WavWriter::Open(const char *path, float sample_rate, Format format,
+                     size_t buffer_frames) {
+  file_ = fopen(path, "wb");
+  if (file_ == nullptr) {
+    return false;
+  }
+  sample_rate_ = sample_rate;
+  format_ = format;
+  sample_bytes_ = format == Format::PCM16 ? 2 : (format == Format::PCM24 ? 3 : 4);
+  buffer_frames_ = buffer_frames;
+  for (auto &buffer : buffers_) {
+    buffer.resize(buffer_frames_ * 2 * sample_bytes_);
+  }
+  data_bytes_ = 0;
+  fill_ = 0;
+  active_ = 0;
+  pending_ = -1;
+  stop_ = false;
+  io_error_ = false;
+
+  WriteHeader(0);  // Sizes get patched in Close()
+  thread_ = std::thread(&WavWriter::WriterLoop, this);
+  return true;
+}
+
+void WavWriter::WriteHeader(uint32_t data_bytes) {
+  const uint16_t format_tag = format_ == Format::FLOAT32 ? kFormatFloat
+                                                         : kFormatPcm;
+  const uint16_t channels = 2;
+  const uint32_t rate = static_cast<uint32_t>(sample_rate_);
+  const uint16_t block_align = static_cast<uint16_t>(channels * sample_bytes_);
+  const uint32_t byte_rate = rate * block_align;
+  const uint16_t bits = static_cast<uint16_t>(sample_bytes_ * 8);
+  const uint32_t riff_size = 36 + data_bytes;
+
+  uint8_t header[44];
+  auto put16 = [&](size_t at, uint16_t v) {
+    header[at] = v & 0xff;
+    header[at + 1] = v >> 8;
+  };
+  auto put32 = [&](size_t at, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+      header[at + i] = (v >> (8 * i)) & 0xff;
+    }
+  };
+  memcpy(header, "RIFF", 4);
+  put32(4, riff_size);
+  memcpy(header + 8, "WAVEfmt ", 8);
+  put32(16, 16);
+  put16(20, format_tag);
+  put16(22, channels);
+  put32(24, rate);
+  put32(28, byte_rate);
+  put16(32, block_align);
+  put16(34, bits);
+  memcpy(header + 36, "data", 4);
+  put32(40, data_bytes);
+  fwrite(header, 1, sizeof(header), file_);
+}
+
+void WavWriter::Write(const float *left, const float *right, size_t frames) {
+  const size_t frame_bytes = 2 * sample_bytes_;
+  for (size_t i = 0; i < frames; i++) {
+    if (fill_ + frame_bytes > buffers_[active_].size()) {
+      HandOff();
+    }
+    uint8_t *p = buffers_[active_].data() + fill_;
+    const float samples[2] = {left[i], right[i]};
+    for (float s : samples) {
+      switch (format_) {
+        case Format::FLOAT32:
+          memcpy(p, &s, 4);
+          break;
+        case Format::PCM16: {
+          s = std::clamp(s, -1.f, 1.f);
+          int16_t v = static_cast<int16_t>(std::lrintf(s * 32767.f));
+          p[0] = v & 0xff;
+          p[1] = (v >> 8) & 0xff;
+          break;
+        }
+        case Format::PCM24: {
+          s = std::clamp(s, -1.f, 1.f);
+          int32_t v = static_cast<int32_t>(std::lrintf(s * 8388607.f));
+          p[0] = v & 0xff;
+          p[1] = (v >> 8) & 0xff;
+          p[2] = (v >> 16) & 0xff;
+          break;
+        }
+      }
+      p += sample_bytes_;
+    }
+    fill_ += frame_bytes;
+  }
+}
+
+void WavWriter::HandOff() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Wait for the writer to finish with the other buffer.
+  cv_.wait(lock, [this] { return pending_ < 0; });
+  pending_ = active_;
+  pending_bytes_ = fill_;
+  active_ ^= 1;
+  fill_ = 0;
+  cv_.notify_all();
+}
+
+void WavWriter::WriterLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return pending_ >= 0 || stop_; });
+    if (pending_ < 0 && stop_) {
+      return;
+    }
+    const int index = pending_;
+    const size_t bytes = pending_bytes_;
+    lock.unlock();
+    if (fwrite(buffers_[index].data(), 1, bytes, file_) != bytes) {
+      io_error_ = true;
+    }
+    lock.lock();
+    data_bytes_ += bytes;
+    pending_ = -1;
+    cv_.notify_all();
+  }
+}
+
+bool WavWriter::Close() {
+  if (file_ == nullptr) {
+    return true;
+  }
+  if (fill_ > 0) {
+    HandOff();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+
+  fseek(file_, 0, SEEK_SET);
+  WriteHeader(static_cast<uint32_t>(data_bytes_));
+  bool ok = !io_error_ && fclose(file_) == 0;
+  file_ = nullptr;
+  return ok;
+}
+
+}  // namespace host
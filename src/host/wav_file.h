@@ -0,0 +1,127 @@
+/*
+ * WAV file streaming for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_WAV_FILE_H
+#define HOST_WAV_FILE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host_runtime.h"
+
+namespace host {
+
+/// @brief Memory-maps a WAV file and streams it out as planar stereo floats.
+///
+/// Reads 16/24/32-bit PCM and 32-bit float. Mono files are copied to both
+/// channels; channels past the second are ignored.
+class WavReader : public AudioSource {
+ public:
+  WavReader() = default;
+  ~WavReader() override;
+
+  WavReader(const WavReader &) = delete;
+  WavReader &operator=(const WavReader &) = delete;
+
+  /// @return False (with a message in `error`) if the file can't be used.
+  bool Open(const char *path, std::string *error);
+
+  size_t Read(float *left, float *right, size_t frames) override;
+  float SampleRate() const override { return sample_rate_; }
+
+  size_t Frames() const { return frames_; }
+  size_t Channels() const { return channels_; }
+  void Rewind() { position_ = 0; }
+
+ private:
+  enum class Encoding { PCM16, PCM24, PCM32, FLOAT32 };
+
+  float Sample(const uint8_t *p) const;
+
+  void *map_ = nullptr;
+  size_t map_size_ = 0;
+  const uint8_t *data_ = nullptr;
+  size_t frames_ = 0;
+  size_t position_ = 0;
+  size_t channels_ = 0;
+  size_t frame_bytes_ = 0;
+  size_t sample_bytes_ = 0;
+  float sample_rate_ = 0.f;
+  Encoding encoding_ = Encoding::PCM16;
+};
+
+/// @brief Writes a stereo WAV file from a background thread.
+///
+/// The audio side fills one buffer while the writer thread flushes the other,
+/// so disk writes never stall the render loop unless the disk falls a whole
+/// buffer behind.
+class WavWriter : public AudioSink {
+ public:
+  enum class Format { FLOAT32, PCM16, PCM24 };
+
+  WavWriter() = default;
+  ~WavWriter() override;
+
+  WavWriter(const WavWriter &) = delete;
+  WavWriter &operator=(const WavWriter &) = delete;
+
+  bool Open(const char *path, float sample_rate, Format format,
+            size_t buffer_frames = 16384);
+
+  void Write(const float *left, const float *right, size_t frames) override;
+
+  /// @brief Flushes everything and fixes up the header sizes.
+  bool Close();
+
+ private:
+  void WriteHeader(uint32_t data_bytes);
+  void HandOff();
+  void WriterLoop();
+
+  FILE *file_ = nullptr;
+  float sample_rate_ = 48000.f;
+  Format format_ = Format::FLOAT32;
+  size_t sample_bytes_ = 4;
+  size_t buffer_frames_ = 0;
+  uint64_t data_bytes_ = 0;
+  bool io_error_ = false;
+
+  std::vector<uint8_t> buffers_[2];
+  size_t fill_ = 0;    // Bytes used in the buffer being filled
+  int active_ = 0;     // Buffer being filled by the audio side
+  int pending_ = -1;   // Buffer waiting for the writer thread, or -1
+  size_t pending_bytes_ = 0;
+  bool stop_ = false;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace host
+
+#endif  // HOST_WAV_FILE_H
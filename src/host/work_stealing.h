@@ -0,0 +1,101 @@
+/*
+ * Work-stealing job scheduler for the Hothouse host tools
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef HOST_WORK_STEALING_H
+#define HOST_WORK_STEALING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace host {
+
+/// @brief Runs `work(job, worker)` for every job from 0 to `jobs` - 1 on
+/// `threads` worker threads, and returns once all of them are done.
+///
+/// The jobs are dealt out round-robin up front and each worker takes its own
+/// from the back of its queue. A worker that runs out steals from the front
+/// of the others' queues, so a few slow jobs (a long decay, an expensive
+/// setting) don't leave the other threads idle at the end.
+///
+/// Jobs can run in any order and on any worker, but `worker` is always below
+/// `threads` and no two jobs run on the same worker at once, so it can index
+/// per-worker state.
+template <typename Work>
+void RunWorkStealing(size_t jobs, size_t threads, Work work) {
+  threads = std::max<size_t>(1, std::min(threads, jobs));
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+  };
+  std::vector<Queue> queues(threads);
+  for (size_t job = 0; job < jobs; job++) {
+    queues[job % threads].jobs.push_back(job);
+  }
+
+  auto next = [&](size_t worker) -> std::optional<size_t> {
+    {
+      Queue &own = queues[worker];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.jobs.empty()) {
+        const size_t job = own.jobs.back();
+        own.jobs.pop_back();
+        return job;
+      }
+    }
+    // Jobs are never added once the workers start, so one pass over the
+    // other queues that finds nothing means there's nothing left.
+    for (size_t i = 1; i < threads; i++) {
+      Queue &victim = queues[(worker + i) % threads];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.jobs.empty()) {
+        const size_t job = victim.jobs.front();
+        victim.jobs.pop_front();
+        return job;
+      }
+    }
+    return std::nullopt;
+  };
+
+  auto run = [&](size_t worker) {
+    while (const std::optional<size_t> job = next(worker)) {
+      work(*job, worker);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t worker = 1; worker < threads; worker++) {
+    workers.emplace_back(run, worker);
+  }
+  run(0);
+  for (std::thread &thread : workers) {
+    thread.join();
+  }
+}
+
+}  // namespace host
+
+#endif  // HOST_WORK_STEALING_H
@@ -19,6 +19,7 @@
 #include "optional"
 
 using clevelandmusicco::Hothouse;
+using clevelandmusicco::LoadMeter;
 using daisy::System;
 
 #ifndef SAMPLE_RATE
@@ -46,6 +47,7 @@ constexpr Pin PIN_KNOB_5 = daisy::seed::D20;
 constexpr Pin PIN_KNOB_6 = daisy::seed::D21;
 
 const uint32_t Hothouse::HOLD_THRESHOLD_MS;
+Hothouse *Hothouse::metered_ = NULL;
 
 void Hothouse::Init(bool boost) {
   // Initialize the hardware.
@@ -65,19 +67,60 @@ void Hothouse::SetHidUpdateRates() {
 }
 
 void Hothouse::StartAudio(AudioHandle::InterleavingAudioCallback cb) {
-  seed.StartAudio(cb);
+  load_meter.Init(AudioSampleRate(), AudioBlockSize());
+  metered_ = this;
+  interleaved_callback_ = cb;
+  seed.StartAudio(MeteredInterleavedCallback);
 }
 
 void Hothouse::StartAudio(AudioHandle::AudioCallback cb) {
-  seed.StartAudio(cb);
+  load_meter.Init(AudioSampleRate(), AudioBlockSize());
+  metered_ = this;
+  callback_ = cb;
+  seed.StartAudio(MeteredCallback);
 }
 
+// The audio interrupt can run at any point in here. Until the new trampoline
+// is installed the old one keeps running, so the pointer it calls is left
+// alone, and the new one is in place before its trampoline can call it. The
+// meter keeps measuring, and only its statistics start over.
 void Hothouse::ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb) {
-  seed.ChangeAudioCallback(cb);
+  interleaved_callback_ = cb;
+  seed.ChangeAudioCallback(MeteredInterleavedCallback);
+  load_meter.Reset();
 }
 
 void Hothouse::ChangeAudioCallback(AudioHandle::AudioCallback cb) {
-  seed.ChangeAudioCallback(cb);
+  callback_ = cb;
+  seed.ChangeAudioCallback(MeteredCallback);
+  load_meter.Reset();
+}
+
+void Hothouse::MeteredCallback(AudioHandle::InputBuffer in,
+                               AudioHandle::OutputBuffer out, size_t size) {
+  metered_->load_meter.OnBlockStart();
+  metered_->callback_(in, out, size);
+  metered_->load_meter.OnBlockEnd();
+}
+
+void Hothouse::MeteredInterleavedCallback(
+    AudioHandle::InterleavingInputBuffer in,
+    AudioHandle::InterleavingOutputBuffer out, size_t size) {
+  metered_->load_meter.OnBlockStart();
+  metered_->interleaved_callback_(in, out, size);
+  metered_->load_meter.OnBlockEnd();
+}
+
+void Hothouse::ShowLoadOnLed(daisy::Led &led) {
+  LoadMeter::Stats stats;
+  load_meter.Read(&stats);
+  const uint32_t now = System::GetNow();
+  if (stats.overruns != load_led_overruns_) {
+    load_led_overruns_ = stats.overruns;
+    load_led_flash_until_ = now + 250;
+  }
+  const bool flashing = static_cast<int32_t>(load_led_flash_until_ - now) > 0;
+  led.Set(flashing ? 1.0f : stats.average);
 }
 
 void Hothouse::StopAudio() { seed.StopAudio(); }
@@ -15,6 +15,7 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "daisy_seed.h"
+#include "load_meter.h"
 #include "optional"
 
 using daisy::AdcChannelConfig;
@@ -188,11 +189,25 @@ class Hothouse {
    */
   void RegisterFootswitchCallbacks(FootswitchCallbacks *callbacks);
 
+  /** Returns the smoothed audio callback load, where 1.0 is the whole block
+   * period. Safe to poll from the main loop. */
+  float GetCpuLoad() { return load_meter.AverageLoad(); }
+
+  /** Debug LED mode: sets the LED's brightness to the audio callback load
+   * instead of whatever it normally shows. The LED lights fully for a quarter
+   * second whenever a block overruns. Call Update() on the LED as usual.
+   * \param led The LED to take over.
+   */
+  void ShowLoadOnLed(daisy::Led &led);
+
   DaisySeed seed; /**< & */
 
   AnalogControl knobs[KNOB_LAST]; /**< & */
   Switch switches[SWITCH_LAST];   /**< & */
 
+  /** Measures every audio callback. It is set up by StartAudio(). */
+  LoadMeter load_meter;
+
  private:
   void SetHidUpdateRates();
   void InitSwitches();
@@ -211,6 +226,22 @@ class Hothouse {
   inline uint16_t* adc_ptr(const uint8_t chn) { return seed.adc.GetPtr(chn); }
 
   FootswitchCallbacks *footswitchCallbacks = NULL;
+
+  // The registered callbacks are called from these so that they can be
+  // measured. libDaisy takes plain function pointers, hence the static
+  // instance pointer.
+  static void MeteredCallback(AudioHandle::InputBuffer in,
+                              AudioHandle::OutputBuffer out, size_t size);
+  static void MeteredInterleavedCallback(
+      AudioHandle::InterleavingInputBuffer in,
+      AudioHandle::InterleavingOutputBuffer out, size_t size);
+
+  static Hothouse *metered_;
+  AudioHandle::AudioCallback callback_ = NULL;
+  AudioHandle::InterleavingAudioCallback interleaved_callback_ = NULL;
+
+  uint32_t load_led_overruns_ = 0;
+  uint32_t load_led_flash_until_ = 0;
 };
 
 }  // namespace clevelandmusicco
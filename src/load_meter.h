@@ -0,0 +1,225 @@
+/*
+ * Audio callback load meter for Hothouse DSP Platform
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef LOAD_METER_H
+#define LOAD_METER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#if defined(__arm__)
+#include "stm32h7xx_hal.h"
+#else
+#include <chrono>
+#endif
+
+namespace clevelandmusicco {
+
+/**
+ * Measures how much of each block period the audio callback uses.
+ *
+ * The audio interrupt calls OnBlockStart() and OnBlockEnd() around the
+ * callback (Hothouse does this for you). The main loop can read the numbers
+ * at any time with Read(), AverageLoad() or PeakLoad() without stopping the
+ * audio: the interrupt never waits on the main loop, and Read() simply tries
+ * again if a block finished while it was copying.
+ *
+ * Loads are fractions of the block period, so 1.0 means the callback used all
+ * of the time it had and anything above that is a dropout.
+ *
+ * On the Daisy the DWT cycle counter is used. Elsewhere the clock defaults to
+ * std::chrono::steady_clock and can be replaced with SetClock(), e.g. by a
+ * host tool that wants to report the load scaled to the pedal's CPU.
+ */
+class LoadMeter {
+ public:
+  /** Histogram bins are 10% of the block period wide. The last bin counts
+   * the blocks that overran. */
+  static const size_t kHistogramBins = 11;
+
+  /** A free-running tick counter that wraps at 2^32. */
+  typedef uint32_t (*Clock)();
+
+  struct Stats {
+    float average;     /**< Smoothed load (about a quarter second) */
+    float peak;        /**< Highest load since the last Reset() */
+    uint32_t blocks;   /**< Blocks measured since the last Reset() */
+    uint32_t overruns; /**< Blocks that took longer than the block period */
+    uint32_t histogram[kHistogramBins]; /**< Blocks per 10% of load */
+  };
+
+  LoadMeter() { Clear(); }
+
+  /** Replaces the clock used by every load meter.
+   * \param clock Tick counter to use.
+   * \param ticks_per_second How fast the counter counts.
+   */
+  static void SetClock(Clock clock, float ticks_per_second) {
+    ClockSettings().clock = clock;
+    ClockSettings().ticks_per_second = ticks_per_second;
+  }
+
+  /** Sets up the meter for a block size and sample rate. Call before audio
+   * starts. */
+  void Init(float sample_rate, size_t block_size) {
+    EnableCycleCounter();
+    const float period_s = static_cast<float>(block_size) / sample_rate;
+    ticks_to_load_ = 1.0f / (period_s * ClockSettings().ticks_per_second);
+    // Average over roughly a quarter second regardless of the block size.
+    smoothing_ = period_s / 0.25f;
+    if (smoothing_ > 1.0f) {
+      smoothing_ = 1.0f;
+    }
+    Clear();
+  }
+
+  /** Call from the audio interrupt just before the callback runs. */
+  inline void OnBlockStart() { start_ticks_ = ClockSettings().clock(); }
+
+  /** Call from the audio interrupt just after the callback returns. */
+  inline void OnBlockEnd() {
+    const uint32_t ticks = ClockSettings().clock() - start_ticks_;
+    const float load = static_cast<float>(ticks) * ticks_to_load_;
+
+    BeginWrite();
+    if (reset_requested_.exchange(false, std::memory_order_relaxed)) {
+      const float average = stats_.average;
+      Clear();
+      stats_.average = average;
+    }
+    stats_.average += smoothing_ * (load - stats_.average);
+    if (load > stats_.peak) {
+      stats_.peak = load;
+    }
+    stats_.blocks++;
+    size_t bin = static_cast<size_t>(load * 10.0f);
+    if (load > 1.0f) {
+      stats_.overruns++;
+      bin = kHistogramBins - 1;
+    } else if (bin > kHistogramBins - 2) {
+      bin = kHistogramBins - 2;  // Exactly 100% still made it
+    }
+    stats_.histogram[bin]++;
+    EndWrite();
+  }
+
+  /** Copies a consistent snapshot of the statistics. Safe to call from the
+   * main loop while audio is running. */
+  void Read(Stats *stats) const {
+    uint32_t before, after;
+    do {
+      before = sequence_.load(std::memory_order_relaxed);
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      *stats = stats_;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      after = sequence_.load(std::memory_order_relaxed);
+    } while (before != after || (before & 1) != 0);
+  }
+
+  /** Returns the smoothed load. */
+  float AverageLoad() const {
+    Stats stats;
+    Read(&stats);
+    return stats.average;
+  }
+
+  /** Returns the highest load since the last Reset(). */
+  float PeakLoad() const {
+    Stats stats;
+    Read(&stats);
+    return stats.peak;
+  }
+
+  /** Starts the peak, counts and histogram over. Takes effect at the end of
+   * the next block, since only the audio interrupt writes the statistics. */
+  void Reset() { reset_requested_.store(true, std::memory_order_relaxed); }
+
+ private:
+  struct ClockConfig {
+    Clock clock;
+    float ticks_per_second;
+  };
+
+  static ClockConfig &ClockSettings() {
+    static ClockConfig config = {DefaultClock, DefaultTicksPerSecond()};
+    return config;
+  }
+
+#if defined(__arm__)
+  static uint32_t DefaultClock() { return DWT->CYCCNT; }
+  static float DefaultTicksPerSecond() {
+    return static_cast<float>(SystemCoreClock);
+  }
+  static void EnableCycleCounter() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;  // The Cortex-M7 DWT is locked out of reset
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  }
+#else
+  static uint32_t DefaultClock() {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+  static float DefaultTicksPerSecond() { return 1e9f; }
+  static void EnableCycleCounter() {}
+#endif
+
+  // The interrupt bumps the sequence number to odd while it updates stats_
+  // and back to even when it's done. Both sides run on the same core, so
+  // compiler fences are enough to keep the accesses in order.
+  inline void BeginWrite() {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  }
+
+  inline void EndWrite() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+  }
+
+  void Clear() {
+    stats_.average = 0.0f;
+    stats_.peak = 0.0f;
+    stats_.blocks = 0;
+    stats_.overruns = 0;
+    for (size_t i = 0; i < kHistogramBins; i++) {
+      stats_.histogram[i] = 0;
+    }
+  }
+
+  float ticks_to_load_ = 0.0f;
+  float smoothing_ = 1.0f;
+  uint32_t start_ticks_ = 0;
+  Stats stats_;
+  std::atomic<uint32_t> sequence_{0};
+  std::atomic<bool> reset_requested_{false};
+};
+
+}  // namespace clevelandmusicco
+
+#endif  // LOAD_METER_H
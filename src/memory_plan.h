@@ -0,0 +1,217 @@
+/*
+ * Static memory planner for Hothouse DSP Platform
+ *
+ * Copyright (c) 2026 Boyd Timothy. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <new>
+
+namespace clevelandmusicco {
+
+/** Where a piece of memory lives. SRAM is the Seed's AXI SRAM (plain .bss),
+ * SDRAM is DSY_SDRAM_BSS. */
+enum MemoryRegion { MEMORY_SRAM, MEMORY_SDRAM, MEMORY_REGION_LAST };
+
+/** Group for memory that is in use whenever the firmware runs. */
+const int kAlwaysActive = 0;
+
+/** What one component of a firmware (a delay line, a reverb's buffer...)
+ * needs. */
+struct MemoryNeed {
+  const char *name;
+  MemoryRegion region;
+  size_t bytes;
+  /** Components that share a group other than kAlwaysActive are never active
+   * at the same time, e.g. the engines a toggle picks between, so they share
+   * their memory. A component is in one group at most, so exclusion has to
+   * go both ways within a group (see MemoryPlan). */
+  int exclusive_group;
+};
+
+/**
+ * Lays out a firmware's memory at compile time.
+ *
+ * Each region gets one pool. Components that are always active get memory of
+ * their own, one after the other in the order they're listed. An exclusive
+ * group gets a single slot as big as its biggest member, placed where its
+ * first member is listed, and every member starts at the beginning of it.
+ * Everything starts on a cache line.
+ *
+ *   constexpr MemoryNeed kMemoryNeeds[] = {
+ *     {"delay L", MEMORY_SDRAM, sizeof(DelayL), kAlwaysActive},
+ *     ...
+ *   };
+ *   constexpr MemoryPlan<2> kMemoryPlan(kMemoryNeeds);
+ *   alignas(MemoryPlan<2>::kAlignment) uint8_t DSY_SDRAM_BSS
+ *       sdram_pool[kMemoryPlan.Footprint(MEMORY_SDRAM)];
+ *
+ * Members of an exclusive group find whatever the last one left behind, so
+ * switching between them has to clear (or Init()) the new one first.
+ *
+ * A group can only say that none of its members is ever active alongside
+ * another. "A is never active with B or C, but B and C run together" can't be
+ * put as groups: list B and C as one component (a struct holding both) in
+ * A's group instead.
+ */
+template <size_t kNeeds>
+class MemoryPlan {
+ public:
+  /** Every component starts on a multiple of this, the Cortex-M7's cache
+   * line. */
+  static const size_t kAlignment = 32;
+
+  constexpr explicit MemoryPlan(const MemoryNeed (&needs)[kNeeds]) {
+    for (size_t i = 0; i < kNeeds; ++i) {
+      needs_[i] = needs[i];
+    }
+    for (size_t i = 0; i < kNeeds; ++i) {
+      const MemoryNeed &need = needs_[i];
+      size_t *footprint = &footprint_[need.region];
+      requested_[need.region] += need.bytes;
+      if (need.exclusive_group == kAlwaysActive) {
+        offsets_[i] = *footprint;
+        *footprint += Aligned(need.bytes);
+        continue;
+      }
+      // Placed already, with an earlier member of the group?
+      size_t first = i;
+      for (size_t j = 0; j < i; ++j) {
+        if (SharesSlot(j, i)) {
+          first = j;
+          break;
+        }
+      }
+      if (first != i) {
+        offsets_[i] = offsets_[first];
+        continue;
+      }
+      size_t slot = 0;
+      for (size_t j = i; j < kNeeds; ++j) {
+        if (SharesSlot(j, i) && Aligned(needs[j].bytes) > slot) {
+          slot = Aligned(needs[j].bytes);
+        }
+      }
+      offsets_[i] = *footprint;
+      *footprint += slot;
+    }
+  }
+
+  /** Where component `need` starts in its region's pool. */
+  constexpr size_t Offset(size_t need) const { return offsets_[need]; }
+
+  /** How big a region's pool has to be. */
+  constexpr size_t Footprint(MemoryRegion region) const {
+    return footprint_[region];
+  }
+
+  /** What the region's components add up to without any sharing. */
+  constexpr size_t Requested(MemoryRegion region) const {
+    return requested_[region];
+  }
+
+  /** Whether every pool fits in its region. */
+  constexpr bool Fits() const {
+    for (size_t r = 0; r < MEMORY_REGION_LAST; ++r) {
+      if (footprint_[r] > Capacity(static_cast<MemoryRegion>(r))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** The Seed's size of a region. The linker has the final say, since the
+   * region also holds everything that isn't planned. */
+  static constexpr size_t Capacity(MemoryRegion region) {
+    return region == MEMORY_SDRAM ? 64 * 1024 * 1024 : 512 * 1024;
+  }
+
+  /** Component `need`'s memory in `pool`, the pool for its region. */
+  template <typename T>
+  T *At(void *pool, size_t need) const {
+    static_assert(alignof(T) <= kAlignment, "component is over-aligned");
+    return reinterpret_cast<T *>(static_cast<uint8_t *>(pool) +
+                                 offsets_[need]);
+  }
+
+  /** Constructs a T in component `need`'s memory. Call after the hardware
+   * is up, since SDRAM isn't usable before that. */
+  template <typename T>
+  T *Construct(void *pool, size_t need) const {
+    return new (At<T>(pool, need)) T;
+  }
+
+  /** Writes the footprint report a line at a time to `print`, which takes a
+   * const char*. */
+  template <typename Print>
+  void Report(Print print) const {
+    char line[96];
+    for (size_t r = 0; r < MEMORY_REGION_LAST; ++r) {
+      const MemoryRegion region = static_cast<MemoryRegion>(r);
+      if (requested_[r] == 0) {
+        continue;
+      }
+      snprintf(line, sizeof(line), "%s: %u bytes (%u requested, %u free)",
+               RegionName(region), static_cast<unsigned>(footprint_[r]),
+               static_cast<unsigned>(requested_[r]),
+               static_cast<unsigned>(Capacity(region) - footprint_[r]));
+      print(line);
+      for (size_t i = 0; i < kNeeds; ++i) {
+        if (needs_[i].region != region) {
+          continue;
+        }
+        snprintf(line, sizeof(line), "  %-16s %8u at %8u  %s",
+                 needs_[i].name, static_cast<unsigned>(needs_[i].bytes),
+                 static_cast<unsigned>(offsets_[i]),
+                 needs_[i].exclusive_group == kAlwaysActive ? "always"
+                                                            : "exclusive");
+        print(line);
+      }
+    }
+  }
+
+  static const char *RegionName(MemoryRegion region) {
+    return region == MEMORY_SDRAM ? "SDRAM" : "SRAM";
+  }
+
+ private:
+  static constexpr size_t Aligned(size_t bytes) {
+    return (bytes + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  constexpr bool SharesSlot(size_t a, size_t b) const {
+    return needs_[a].region == needs_[b].region &&
+           needs_[a].exclusive_group == needs_[b].exclusive_group;
+  }
+
+  MemoryNeed needs_[kNeeds] = {};
+  size_t offsets_[kNeeds] = {};
+  size_t footprint_[MEMORY_REGION_LAST] = {};
+  size_t requested_[MEMORY_REGION_LAST] = {};
+};
+
+}  // namespace clevelandmusicco
+
+#endif  // MEMORY_PLAN_H
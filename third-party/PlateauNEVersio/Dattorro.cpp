@@ -7,7 +7,9 @@
 
 Dattorro1997Tank::Dattorro1997Tank(const float initSampleRate,
                                    const float initMaxLfoDepth,
-                                   const float initMaxTimeScale) :
+                                   const float initMaxTimeScale,
+                                   DelayArena& arena) :
+    arena(&arena),
     maxTimeScale(initMaxTimeScale) 
 {
     timePadding = initMaxLfoDepth;
@@ -27,19 +29,10 @@ Dattorro1997Tank::Dattorro1997Tank(const float initSampleRate,
     // leftOutDCBlock.setCutoffFreq(-0.004);
     // rightOutDCBlock.setCutoffFreq(-0.004);
 
-    lfo1.setFrequency(lfo1Freq);
-    lfo2.setFrequency(lfo2Freq);
-    lfo3.setFrequency(lfo3Freq);
-    lfo4.setFrequency(lfo4Freq);
-
-    lfo2.phase = 0.25;
-    lfo3.phase = 0.5;
-    lfo4.phase = 0.75;
-
-    lfo1.setRevPoint(0.5);
-    lfo2.setRevPoint(0.5);
-    lfo3.setRevPoint(0.5);
-    lfo4.setRevPoint(0.5);
+    lfos.setFrequency(LEFT_APF_1_LFO, lfo1Freq);
+    lfos.setFrequency(LEFT_APF_2_LFO, lfo2Freq);
+    lfos.setFrequency(RIGHT_APF_1_LFO, lfo3Freq);
+    lfos.setFrequency(RIGHT_APF_2_LFO, lfo4Freq);
 }
 
 void Dattorro1997Tank::process(const float leftIn, const float rightIn,
@@ -52,22 +45,25 @@ void Dattorro1997Tank::process(const float leftIn, const float rightIn,
     leftSum += leftIn;
     rightSum += rightIn;
 
+    // On the low tier the modulated allpasses read whole samples.
+    const bool wholeSample = quality == QUALITY_LOW;
+
     leftApf1.input = leftSum;
-    leftDelay1.input = leftApf1.process();
+    leftDelay1.input = wholeSample ? leftApf1.processWholeSample(leftSum) : leftApf1.process();
     leftDelay1.process();
     leftHighCutFilter.input = leftDelay1.output;
     leftLowCutFilter.input = leftHighCutFilter.process();
     leftApf2.input = (leftDelay1.output * (1. - fade) + leftLowCutFilter.process() * fade) * decay;
-    leftDelay2.input = leftApf2.process();
+    leftDelay2.input = wholeSample ? leftApf2.processWholeSample(leftApf2.input) : leftApf2.process();
     leftDelay2.process();
 
     rightApf1.input = rightSum;
-    rightDelay1.input = rightApf1.process();
+    rightDelay1.input = wholeSample ? rightApf1.processWholeSample(rightSum) : rightApf1.process();
     rightDelay1.process();
     rightHighCutFilter.input = rightDelay1.output;
     rightLowCutFilter.input =  rightHighCutFilter.process();
     rightApf2.input = (rightDelay1.output * (1. - fade) + rightLowCutFilter.process() * fade) * decay;
-    rightDelay2.input = rightApf2.process();
+    rightDelay2.input = wholeSample ? rightApf2.processWholeSample(rightApf2.input) : rightApf2.process();
     rightDelay2.process();
 
     rightSum = leftDelay2.output * decay;
@@ -98,6 +94,232 @@ void Dattorro1997Tank::process(const float leftIn, const float rightIn,
     fade = (fade < 0.) ? 0. : ((fade > 1.) ? 1. : fade);
 }
 
+// Steps a delay or allpass, skipping the interpolation when every delay
+// time is a whole number of samples.
+template <bool wholeSample, typename Delay>
+static inline float processDelay(Delay& delay, const float in) {
+    return wholeSample ? delay.processWholeSample(in) : delay.process(in);
+}
+
+void Dattorro1997Tank::process(const float* leftIn, const float* rightIn,
+                               float* leftOut, float* rightOut, size_t size) {
+    // Pick the loop that does only what the current settings need. Without
+    // modulation the allpass times are the same for the whole block, and
+    // once the freeze fade has finished it's the same as no fade at all. On
+    // the low tier the modulated allpasses read whole samples as well.
+    const bool modulated = lfoExcursion != 0.;
+    if (!modulated) {
+        leftApf1.delay.setDelayTime(scaledLeftApf1Time);
+        leftApf2.delay.setDelayTime(scaledLeftApf2Time);
+        rightApf1.delay.setDelayTime(scaledRightApf1Time);
+        rightApf2.delay.setDelayTime(scaledRightApf2Time);
+    }
+    const bool wholeSampleApfs = quality == QUALITY_LOW || (!modulated &&
+        leftApf1.delay.isWholeSample() && leftApf2.delay.isWholeSample() &&
+        rightApf1.delay.isWholeSample() && rightApf2.delay.isWholeSample());
+    const bool wholeSample = wholeSampleApfs &&
+        leftDelay1.isWholeSample() && leftDelay2.isWholeSample() &&
+        rightDelay1.isWholeSample() && rightDelay2.isWholeSample();
+    const bool fading = !(fade == 1. && fadeDir > 0.);
+
+    if (modulated && wholeSample) {
+        if (fading) {
+            processBlock<true, true, true>(leftIn, rightIn, leftOut, rightOut, size);
+        } else {
+            processBlock<true, true, false>(leftIn, rightIn, leftOut, rightOut, size);
+        }
+    } else if (modulated) {
+        if (fading) {
+            processBlock<true, false, true>(leftIn, rightIn, leftOut, rightOut, size);
+        } else {
+            processBlock<true, false, false>(leftIn, rightIn, leftOut, rightOut, size);
+        }
+    } else if (wholeSample) {
+        if (fading) {
+            processBlock<false, true, true>(leftIn, rightIn, leftOut, rightOut, size);
+        } else {
+            processBlock<false, true, false>(leftIn, rightIn, leftOut, rightOut, size);
+        }
+    } else {
+        if (fading) {
+            processBlock<false, false, true>(leftIn, rightIn, leftOut, rightOut, size);
+        } else {
+            processBlock<false, false, false>(leftIn, rightIn, leftOut, rightOut, size);
+        }
+    }
+}
+
+template <bool modulated, bool wholeSample, bool fading>
+void Dattorro1997Tank::processBlock(const float* leftIn, const float* rightIn,
+                                    float* leftOut, float* rightOut, size_t size) {
+    // Work on local copies. Every write to the delay memory could otherwise
+    // alias any float member, which would force the whole state to be stored
+    // and reloaded around each one.
+    TriSawLFOBank<NUM_APF_LFOS> lfosLocal = lfos;
+    float apfTimeSlopesLocal[NUM_APF_LFOS];
+    for (int k = 0; k < NUM_APF_LFOS; ++k) {
+        apfTimeSlopesLocal[k] = apfTimeSlopes[k];
+    }
+
+    AllpassFilter leftApf1Local = leftApf1;
+    InterpDelay leftDelay1Local = leftDelay1;
+    OnePoleLPFilter leftHighCutLocal = leftHighCutFilter;
+    OnePoleHPFilter leftLowCutLocal = leftLowCutFilter;
+    AllpassFilter leftApf2Local = leftApf2;
+    InterpDelay leftDelay2Local = leftDelay2;
+
+    AllpassFilter rightApf1Local = rightApf1;
+    InterpDelay rightDelay1Local = rightDelay1;
+    OnePoleLPFilter rightHighCutLocal = rightHighCutFilter;
+    OnePoleHPFilter rightLowCutLocal = rightLowCutFilter;
+    AllpassFilter rightApf2Local = rightApf2;
+    InterpDelay rightDelay2Local = rightDelay2;
+
+    OnePoleHPFilter leftDCBlockLocal = leftOutDCBlock;
+    OnePoleHPFilter rightDCBlockLocal = rightOutDCBlock;
+
+    const std::array<int, 7> taps = scaledOutputTaps;
+    const float excursion = lfoExcursion;
+    const float leftApf1Base = scaledLeftApf1Time;
+    const float leftApf2Base = scaledLeftApf2Time;
+    const float rightApf1Base = scaledRightApf1Time;
+    const float rightApf2Base = scaledRightApf2Time;
+    const float step = fadeStep * fadeDir;
+
+    decay = decayParam;
+    const float decayLocal = decay;
+    float leftSumLocal = leftSum;
+    float rightSumLocal = rightSum;
+    float fadeLocal = fade;
+
+    // The output taps, read a chunk at a time before the chunk runs (see
+    // TapGather). The right channel's are the second seven.
+    TapGather<14, kTapChunk> gather;
+    gather.set(L_DELAY_1_L_TAP_1, leftDelay1Local, taps[L_DELAY_1_L_TAP_1]);
+    gather.set(L_DELAY_1_L_TAP_2, leftDelay1Local, taps[L_DELAY_1_L_TAP_2]);
+    gather.set(L_APF_2_L_TAP, leftApf2Local.delay, taps[L_APF_2_L_TAP]);
+    gather.set(L_DELAY_2_L_TAP, leftDelay2Local, taps[L_DELAY_2_L_TAP]);
+    gather.set(R_DELAY_1_L_TAP, rightDelay1Local, taps[R_DELAY_1_L_TAP]);
+    gather.set(R_APF_2_L_TAP, rightApf2Local.delay, taps[R_APF_2_L_TAP]);
+    gather.set(R_DELAY_2_L_TAP, rightDelay2Local, taps[R_DELAY_2_L_TAP]);
+    gather.set(7 + R_DELAY_1_R_TAP_1, rightDelay1Local, taps[R_DELAY_1_R_TAP_1]);
+    gather.set(7 + R_DELAY_1_R_TAP_2, rightDelay1Local, taps[R_DELAY_1_R_TAP_2]);
+    gather.set(7 + R_APF_2_R_TAP, rightApf2Local.delay, taps[R_APF_2_R_TAP]);
+    gather.set(7 + R_DELAY_2_R_TAP, rightDelay2Local, taps[R_DELAY_2_R_TAP]);
+    gather.set(7 + L_DELAY_1_R_TAP, leftDelay1Local, taps[L_DELAY_1_R_TAP]);
+    gather.set(7 + L_APF_2_R_TAP, leftApf2Local.delay, taps[L_APF_2_R_TAP]);
+    gather.set(7 + L_DELAY_2_R_TAP, leftDelay2Local, taps[L_DELAY_2_R_TAP]);
+    const size_t chunk = (size_t)gather.maxBlock();
+
+    for (size_t start = 0; start < size; start += chunk) {
+        const size_t chunkSize = size - start < chunk ? size - start : chunk;
+        gather.gather((int)chunkSize);
+
+        for (size_t n = 0; n < chunkSize; ++n) {
+            const size_t i = start + n;
+            if (modulated) {
+                // Same as tickApfModulation()
+                if (lfosLocal.tick()) {
+                    leftApf1Local.delay.setDelayTime(lfosLocal.getValue(LEFT_APF_1_LFO) * excursion + leftApf1Base);
+                    leftApf2Local.delay.setDelayTime(lfosLocal.getValue(LEFT_APF_2_LFO) * excursion + leftApf2Base);
+                    rightApf1Local.delay.setDelayTime(lfosLocal.getValue(RIGHT_APF_1_LFO) * excursion + rightApf1Base);
+                    rightApf2Local.delay.setDelayTime(lfosLocal.getValue(RIGHT_APF_2_LFO) * excursion + rightApf2Base);
+                    for (int k = 0; k < NUM_APF_LFOS; ++k) {
+                        apfTimeSlopesLocal[k] = lfosLocal.getSlope(k) * excursion;
+                    }
+                } else {
+                    leftApf1Local.delay.rampDelayTime(apfTimeSlopesLocal[LEFT_APF_1_LFO]);
+                    leftApf2Local.delay.rampDelayTime(apfTimeSlopesLocal[LEFT_APF_2_LFO]);
+                    rightApf1Local.delay.rampDelayTime(apfTimeSlopesLocal[RIGHT_APF_1_LFO]);
+                    rightApf2Local.delay.rampDelayTime(apfTimeSlopesLocal[RIGHT_APF_2_LFO]);
+                }
+            }
+
+            leftSumLocal += leftIn[i];
+            rightSumLocal += rightIn[i];
+
+            const float leftApf1Out = processDelay<wholeSample>(leftApf1Local, leftSumLocal);
+            const float leftDelay1Out = processDelay<wholeSample>(leftDelay1Local, leftApf1Out);
+            const float leftFiltered = leftLowCutLocal.process(leftHighCutLocal.process(leftDelay1Out));
+            const float leftApf2In = fading ?
+                (leftDelay1Out * (1. - fadeLocal) + leftFiltered * fadeLocal) * decayLocal :
+                leftFiltered * decayLocal;
+            const float leftDelay2Out = processDelay<wholeSample>(leftDelay2Local,
+                processDelay<wholeSample>(leftApf2Local, leftApf2In));
+
+            const float rightApf1Out = processDelay<wholeSample>(rightApf1Local, rightSumLocal);
+            const float rightDelay1Out = processDelay<wholeSample>(rightDelay1Local, rightApf1Out);
+            const float rightFiltered = rightLowCutLocal.process(rightHighCutLocal.process(rightDelay1Out));
+            const float rightApf2In = fading ?
+                (rightDelay1Out * (1. - fadeLocal) + rightFiltered * fadeLocal) * decayLocal :
+                rightFiltered * decayLocal;
+            const float rightDelay2Out = processDelay<wholeSample>(rightDelay2Local,
+                processDelay<wholeSample>(rightApf2Local, rightApf2In));
+
+            rightSumLocal = leftDelay2Out * decayLocal;
+            leftSumLocal = rightDelay2Out * decayLocal;
+
+            float left = leftApf1Out;
+            left += gather[L_DELAY_1_L_TAP_1][n];
+            left += gather[L_DELAY_1_L_TAP_2][n];
+            left -= gather[L_APF_2_L_TAP][n];
+            left += gather[L_DELAY_2_L_TAP][n];
+            left -= gather[R_DELAY_1_L_TAP][n];
+            left -= gather[R_APF_2_L_TAP][n];
+            left -= gather[R_DELAY_2_L_TAP][n];
+
+            float right = rightApf1Out;
+            right += gather[7 + R_DELAY_1_R_TAP_1][n];
+            right += gather[7 + R_DELAY_1_R_TAP_2][n];
+            right -= gather[7 + R_APF_2_R_TAP][n];
+            right += gather[7 + R_DELAY_2_R_TAP][n];
+            right -= gather[7 + L_DELAY_1_R_TAP][n];
+            right -= gather[7 + L_APF_2_R_TAP][n];
+            right -= gather[7 + L_DELAY_2_R_TAP][n];
+
+            leftOut[i] = leftDCBlockLocal.process(left) * 0.5;
+            rightOut[i] = rightDCBlockLocal.process(right) * 0.5;
+
+            if (fading) {
+                fadeLocal += step;
+                fadeLocal = (fadeLocal < 0.) ? 0. : ((fadeLocal > 1.) ? 1. : fadeLocal);
+            }
+        }
+    }
+
+    if (modulated) {
+        lfos = lfosLocal;
+        for (int k = 0; k < NUM_APF_LFOS; ++k) {
+            apfTimeSlopes[k] = apfTimeSlopesLocal[k];
+        }
+    } else {
+        // Keep the LFOs where they would have been, so turning the
+        // modulation back on doesn't depend on how long it was off.
+        lfos.skip(size);
+    }
+
+    leftApf1 = leftApf1Local;
+    leftDelay1 = leftDelay1Local;
+    leftHighCutFilter = leftHighCutLocal;
+    leftLowCutFilter = leftLowCutLocal;
+    leftApf2 = leftApf2Local;
+    leftDelay2 = leftDelay2Local;
+
+    rightApf1 = rightApf1Local;
+    rightDelay1 = rightDelay1Local;
+    rightHighCutFilter = rightHighCutLocal;
+    rightLowCutFilter = rightLowCutLocal;
+    rightApf2 = rightApf2Local;
+    rightDelay2 = rightDelay2Local;
+
+    leftOutDCBlock = leftDCBlockLocal;
+    rightOutDCBlock = rightDCBlockLocal;
+
+    leftSum = leftSumLocal;
+    rightSum = rightSumLocal;
+    fade = fadeLocal;
+}
+
 void Dattorro1997Tank::freeze(bool freezeFlag) {
     frozen = freezeFlag;
     if (frozen) {
@@ -138,16 +360,21 @@ void Dattorro1997Tank::setTimeScale(const float newTimeScale) {
 
 #pragma GCC pop_options
 
+void Dattorro1997Tank::setWholeSampleDelays(const bool enable) {
+    wholeSampleDelays = enable;
+    rescaleApfAndDelayTimes();
+}
+
 void Dattorro1997Tank::setDecay(const float newDecay) {
     decayParam = (float)(newDecay > 1. ? 1. :
                          (newDecay < 0. ? 0. : newDecay));
 }
 
 void Dattorro1997Tank::setModSpeed(const float newModSpeed) {
-    lfo1.setFrequency(lfo1Freq * newModSpeed);
-    lfo2.setFrequency(lfo2Freq * newModSpeed);
-    lfo3.setFrequency(lfo3Freq * newModSpeed);
-    lfo4.setFrequency(lfo4Freq * newModSpeed);
+    lfos.setFrequency(LEFT_APF_1_LFO, lfo1Freq * newModSpeed);
+    lfos.setFrequency(LEFT_APF_2_LFO, lfo2Freq * newModSpeed);
+    lfos.setFrequency(RIGHT_APF_1_LFO, lfo3Freq * newModSpeed);
+    lfos.setFrequency(RIGHT_APF_2_LFO, lfo4Freq * newModSpeed);
 }
 
 void Dattorro1997Tank::setModDepth(const float newModDepth) {
@@ -156,10 +383,29 @@ void Dattorro1997Tank::setModDepth(const float newModDepth) {
 }
 
 void Dattorro1997Tank::setModShape(const float shape) {
-    lfo1.setRevPoint(shape);
-    lfo2.setRevPoint(shape);
-    lfo3.setRevPoint(shape);
-    lfo4.setRevPoint(shape);
+    for (int k = 0; k < NUM_APF_LFOS; ++k) {
+        lfos.setRevPoint(k, shape);
+    }
+}
+
+void Dattorro1997Tank::setModPeriod(int samples) {
+    lfos.setPeriod(samples);
+}
+
+void Dattorro1997Tank::setQuality(ReverbQuality newQuality) {
+    quality = newQuality;
+    switch (quality) {
+    case QUALITY_LOW:
+        setModPeriod(256);
+        break;
+    case QUALITY_MEDIUM:
+        setModPeriod(128);
+        break;
+    case QUALITY_HIGH:
+        setModPeriod(TriSawLFOBank<NUM_APF_LFOS>::kDefaultPeriod);
+        break;
+    }
+    rescaleApfAndDelayTimes();
 }
 
 void Dattorro1997Tank::setHighCutFrequency(const float frequency) {
@@ -195,18 +441,32 @@ void Dattorro1997Tank::setDiffusion(const float diffusion) {
 void Dattorro1997Tank::clear() {
     leftApf1.clear();
     leftDelay1.clear();
-    leftHighCutFilter.clear();
-    leftLowCutFilter.clear();
     leftApf2.clear();
     leftDelay2.clear();
 
     rightApf1.clear();
     rightDelay1.clear();
-    rightHighCutFilter.clear();;
-    rightLowCutFilter.clear();
     rightApf2.clear();
     rightDelay2.clear();
 
+    clearFilters();
+}
+
+void Dattorro1997Tank::clearFilters() {
+    leftApf1.input = 0.;
+    leftApf1.output = 0.;
+    leftHighCutFilter.clear();
+    leftLowCutFilter.clear();
+    leftApf2.input = 0.;
+    leftApf2.output = 0.;
+
+    rightApf1.input = 0.;
+    rightApf1.output = 0.;
+    rightHighCutFilter.clear();
+    rightLowCutFilter.clear();
+    rightApf2.input = 0.;
+    rightApf2.output = 0.;
+
     leftOutDCBlock.clear();
     rightOutDCBlock.clear();
 
@@ -214,8 +474,6 @@ void Dattorro1997Tank::clear() {
     rightSum = 0.;
 }
 
-int maxScaledOutputTap = 0;
-
 inline int Dattorro1997Tank::calcMaxTime(float delayTime) {
     maxScaledOutputTap = *std::max_element(scaledOutputTaps.begin(),
                                                 scaledOutputTaps.end());
@@ -241,41 +499,65 @@ void Dattorro1997Tank::initialiseDelaysAndApfs() {
     const int kRightApf2MaxTime = calcMaxTime(rightApf2Time);
     const int kRightDelay2MaxTime = calcMaxTime(rightDelay2Time);
 
-    leftApf1 = AllpassFilter(kLeftApf1MaxTime);
-    leftDelay1 = InterpDelay(kLeftDelay1MaxTime);
-    leftApf2 = AllpassFilter(kLeftApf2MaxTime);
-    leftDelay2 = InterpDelay(kLeftDelay2MaxTime);
-    rightApf1 = AllpassFilter(kRightApf1MaxTime);
-    rightDelay1 = InterpDelay(kRightDelay1MaxTime);
-    rightApf2 = AllpassFilter(kRightApf2MaxTime);
-    rightDelay2 = InterpDelay(kRightDelay2MaxTime);
+    // reset() rather than assigning new ones, so that setting the sample
+    // rate again reuses the memory instead of taking more of the arena.
+    leftApf1.reset(kLeftApf1MaxTime, 0, 0., *arena);
+    leftDelay1.reset(kLeftDelay1MaxTime, *arena);
+    leftApf2.reset(kLeftApf2MaxTime, 0, 0., *arena);
+    leftDelay2.reset(kLeftDelay2MaxTime, *arena);
+    rightApf1.reset(kRightApf1MaxTime, 0, 0., *arena);
+    rightDelay1.reset(kRightDelay1MaxTime, *arena);
+    rightApf2.reset(kRightApf2MaxTime, 0, 0., *arena);
+    rightDelay2.reset(kRightDelay2MaxTime, *arena);
+
+    // The output taps (see process()), for deciding where the delays go.
+    leftDelay1.setTapsPerSample(3);
+    leftApf2.delay.setTapsPerSample(2);
+    leftDelay2.setTapsPerSample(2);
+    rightDelay1.setTapsPerSample(3);
+    rightApf2.delay.setTapsPerSample(2);
+    rightDelay2.setTapsPerSample(2);
 }
 
+// The allpass times are set from the LFOs at the start of each period and
+// ramped towards the next one in between.
 void Dattorro1997Tank::tickApfModulation() {
-    leftApf1.delay.setDelayTime(lfo1.process() * lfoExcursion + scaledLeftApf1Time);
-    leftApf2.delay.setDelayTime(lfo2.process() * lfoExcursion + scaledLeftApf2Time);
-    rightApf1.delay.setDelayTime(lfo3.process() * lfoExcursion + scaledRightApf1Time);
-    rightApf2.delay.setDelayTime(lfo4.process() * lfoExcursion + scaledRightApf2Time);
+    if (lfos.tick()) {
+        leftApf1.delay.setDelayTime(lfos.getValue(LEFT_APF_1_LFO) * lfoExcursion + scaledLeftApf1Time);
+        leftApf2.delay.setDelayTime(lfos.getValue(LEFT_APF_2_LFO) * lfoExcursion + scaledLeftApf2Time);
+        rightApf1.delay.setDelayTime(lfos.getValue(RIGHT_APF_1_LFO) * lfoExcursion + scaledRightApf1Time);
+        rightApf2.delay.setDelayTime(lfos.getValue(RIGHT_APF_2_LFO) * lfoExcursion + scaledRightApf2Time);
+        for (int k = 0; k < NUM_APF_LFOS; ++k) {
+            apfTimeSlopes[k] = lfos.getSlope(k) * lfoExcursion;
+        }
+    } else {
+        leftApf1.delay.rampDelayTime(apfTimeSlopes[LEFT_APF_1_LFO]);
+        leftApf2.delay.rampDelayTime(apfTimeSlopes[LEFT_APF_2_LFO]);
+        rightApf1.delay.rampDelayTime(apfTimeSlopes[RIGHT_APF_1_LFO]);
+        rightApf2.delay.rampDelayTime(apfTimeSlopes[RIGHT_APF_2_LFO]);
+    }
 }
 
-float scaleFactor = 0.;
-
-
 #pragma GCC push_options
 #pragma GCC optimize ("Ofast")
 
 void Dattorro1997Tank::rescaleApfAndDelayTimes() {
-    scaleFactor = timeScale * sampleRateScale;
+    const float scaleFactor = timeScale * sampleRateScale;
+
+    const bool round = wholeSampleDelays || quality != QUALITY_HIGH;
+    const auto scale = [round, scaleFactor](float time) {
+        return round ? std::round(time * scaleFactor) : time * scaleFactor;
+    };
 
-    scaledLeftApf1Time = leftApf1Time * scaleFactor;
-    scaledLeftDelay1Time = leftDelay1Time * scaleFactor;
-    scaledLeftApf2Time = leftApf2Time * scaleFactor;
-    scaledLeftDelay2Time = leftDelay2Time * scaleFactor;
+    scaledLeftApf1Time = scale(leftApf1Time);
+    scaledLeftDelay1Time = scale(leftDelay1Time);
+    scaledLeftApf2Time = scale(leftApf2Time);
+    scaledLeftDelay2Time = scale(leftDelay2Time);
 
-    scaledRightApf1Time = rightApf1Time * scaleFactor;
-    scaledRightDelay1Time = rightDelay1Time * scaleFactor;
-    scaledRightApf2Time = rightApf2Time * scaleFactor;
-    scaledRightDelay2Time = rightDelay2Time * scaleFactor;
+    scaledRightApf1Time = scale(rightApf1Time);
+    scaledRightDelay1Time = scale(rightDelay1Time);
+    scaledRightApf2Time = scale(rightApf2Time);
+    scaledRightDelay2Time = scale(rightDelay2Time);
 
     leftDelay1.setDelayTime(scaledLeftDelay1Time);
     leftDelay2.setDelayTime(scaledLeftDelay2Time);
@@ -288,18 +570,23 @@ void Dattorro1997Tank::rescaleApfAndDelayTimes() {
 void Dattorro1997Tank::rescaleTapTimes() {
     for (size_t i = 0; i < scaledOutputTaps.size(); ++i) {
         scaledOutputTaps[i] = (int)((float)kOutputTaps[i] * sampleRateScale);
+        // Only below 300 Hz or so, but the block process() needs every tap
+        // to be longer than a sample (see TapGather).
+        scaledOutputTaps[i] = scaledOutputTaps[i] < 2 ? 2 : scaledOutputTaps[i];
     }
 }
 
 Dattorro::Dattorro(const float initMaxSampleRate,
                    const float initMaxLfoDepth,
-                   const float initMaxTimeScale)
-    : tank(initMaxSampleRate, initMaxLfoDepth, initMaxTimeScale)
+                   const float initMaxTimeScale,
+                   DelayArena& arena)
+    : tank(initMaxSampleRate, initMaxLfoDepth, initMaxTimeScale, arena)
 {
     sampleRate = initMaxSampleRate;
     dattorroScaleFactor = sampleRate / dattorroSampleRate;
 
-    preDelay = InterpDelay(192010, 0.);
+    // Four seconds, plus a little
+    preDelay.reset((int)(initMaxSampleRate * 4) + 10, arena);
 
     // // 22000 goes outside the range fo the linear function.
     // // inputLpf = OnePoleLPFilter(22000.0);
@@ -309,10 +596,10 @@ Dattorro::Dattorro(const float initMaxSampleRate,
     inputLpf = OnePoleLPFilter(22000.0);
     inputHpf = OnePoleHPFilter(0.0);
 
-    inApf1 = AllpassFilter(dattorroScale(8 * kInApf1Time), dattorroScale(kInApf1Time), inputDiffusion1);
-    inApf2 = AllpassFilter(dattorroScale(8 * kInApf2Time), dattorroScale(kInApf2Time), inputDiffusion1);
-    inApf3 = AllpassFilter(dattorroScale(8 * kInApf3Time), dattorroScale(kInApf3Time), inputDiffusion2);
-    inApf4 = AllpassFilter(dattorroScale(8 * kInApf4Time), dattorroScale(kInApf4Time), inputDiffusion2);
+    inApf1.reset(dattorroScale(8 * kInApf1Time), dattorroScale(kInApf1Time), inputDiffusion1, arena);
+    inApf2.reset(dattorroScale(8 * kInApf2Time), dattorroScale(kInApf2Time), inputDiffusion1, arena);
+    inApf3.reset(dattorroScale(8 * kInApf3Time), dattorroScale(kInApf3Time), inputDiffusion2, arena);
+    inApf4.reset(dattorroScale(8 * kInApf4Time), dattorroScale(kInApf4Time), inputDiffusion2, arena);
 
     // // leftInputDCBlock.setCutoffFreq(20.0);
     // // rightInputDCBlock.setCutoffFreq(20.0);
@@ -342,12 +629,149 @@ void Dattorro::process(float leftInput, float rightInput) {
     preDelay.input = inputHpf.output;
     preDelay.process();
     inApf1.input = preDelay.output;
-    inApf2.input = inApf1.process();
-    inApf3.input = inApf2.process();
-    inApf4.input = inApf3.process();
-    tankFeed = preDelay.output * (1. - diffuseInput) + inApf4.process() * diffuseInput;
+    float diffused;
+    const Diffusers diffusers = prepareDiffusers(1);
+    if (diffusers == DIFFUSERS_OUT) {
+        inApf3.input = inApf1.process();
+        diffused = inApf3.process();
+    } else if (diffusers == DIFFUSERS_IN) {
+        inApf2.input = inApf1.process();
+        inApf3.input = inApf2.process();
+        inApf4.input = inApf3.process();
+        diffused = inApf4.process();
+    } else {
+        const float fadeLocal = stepDiffuserFade();
+        inApf2.input = inApf1.process();
+        inApf3.input = inApf2.input + (inApf2.process() - inApf2.input) * fadeLocal;
+        inApf4.input = inApf3.process();
+        diffused = inApf4.input + (inApf4.process() - inApf4.input) * fadeLocal;
+    }
+    tankFeed = preDelay.output * (1. - diffuseInput) + diffused * diffuseInput;
 
     tank.process(tankFeed, tankFeed, &leftOut, &rightOut);
+
+    if (outputStep != 0. || outputLevel != 1.) {
+        stepOutputLevel();
+        leftOut *= outputLevel;
+        rightOut *= outputLevel;
+    }
+}
+
+void Dattorro::process(const float* leftIn, const float* rightIn,
+                       float* leftOutput, float* rightOutput, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    switch (quality) {
+    case QUALITY_LOW:
+        processAtQuality<QUALITY_LOW>(leftIn, rightIn, leftOutput, rightOutput, size);
+        break;
+    case QUALITY_MEDIUM:
+        processAtQuality<QUALITY_MEDIUM>(leftIn, rightIn, leftOutput, rightOutput, size);
+        break;
+    case QUALITY_HIGH:
+        processAtQuality<QUALITY_HIGH>(leftIn, rightIn, leftOutput, rightOutput, size);
+        break;
+    }
+}
+
+template <ReverbQuality tier>
+void Dattorro::processAtQuality(const float* leftIn, const float* rightIn,
+                                float* leftOutput, float* rightOutput, size_t size) {
+    if (diffuseInput == 0.) {
+        processBlock<INPUT_DIFFUSION_OFF, tier>(leftIn, rightIn, leftOutput, rightOutput, size);
+    } else if (diffuseInput == 1.) {
+        processBlock<INPUT_DIFFUSION_ON, tier>(leftIn, rightIn, leftOutput, rightOutput, size);
+    } else {
+        processBlock<INPUT_DIFFUSION_MIXED, tier>(leftIn, rightIn, leftOutput, rightOutput, size);
+    }
+}
+
+template <Dattorro::InputDiffusion diffusion, ReverbQuality tier>
+void Dattorro::processBlock(const float* leftIn, const float* rightIn,
+                            float* leftOutput, float* rightOutput, size_t size) {
+    // The cutoffs only change between blocks.
+    inputLpf.setCutoffFreq(inputHighCut);
+    inputHpf.setCutoffFreq(inputLowCut);
+    const Diffusers diffusers = prepareDiffusers(size);
+
+    // Local copies for the same reason as in the tank.
+    OnePoleHPFilter leftDCBlockLocal = leftInputDCBlock;
+    OnePoleHPFilter rightDCBlockLocal = rightInputDCBlock;
+    OnePoleLPFilter lpfLocal = inputLpf;
+    OnePoleHPFilter hpfLocal = inputHpf;
+    InterpDelay preDelayLocal = preDelay;
+    AllpassFilter apf1Local = inApf1;
+    AllpassFilter apf2Local = inApf2;
+    AllpassFilter apf3Local = inApf3;
+    AllpassFilter apf4Local = inApf4;
+    const float diffuse = diffuseInput;
+    float fadeLocal = diffuserFade;
+    const float fadeStep = diffuserFadeDir / (diffuserFadeTime * sampleRate);
+    // Below QUALITY_HIGH the input side's delay times are whole samples.
+    const bool wholeSample = tier != QUALITY_HIGH;
+
+    // The input side doesn't depend on the tank, so it runs a chunk ahead
+    // and the tank then takes the whole chunk.
+    float feed[kTankChunk];
+    for (size_t start = 0; start < size; start += kTankChunk) {
+        const size_t n = std::min(kTankChunk, size - start);
+        for (size_t i = 0; i < n; ++i) {
+            const float mono = leftDCBlockLocal.process(leftIn[start + i]) +
+                               rightDCBlockLocal.process(rightIn[start + i]);
+            const float delayed = processDelay<wholeSample>(preDelayLocal,
+                hpfLocal.process(lpfLocal.process(mono)));
+            if (diffusion == INPUT_DIFFUSION_OFF) {
+                feed[i] = delayed;
+                continue;
+            }
+            float diffused = processDelay<wholeSample>(apf1Local, delayed);
+            if (diffusers == DIFFUSERS_IN) {
+                diffused = processDelay<wholeSample>(apf2Local, diffused);
+                diffused = processDelay<wholeSample>(apf3Local, diffused);
+                diffused = processDelay<wholeSample>(apf4Local, diffused);
+            } else if (diffusers == DIFFUSERS_OUT) {
+                diffused = processDelay<wholeSample>(apf3Local, diffused);
+            } else {
+                fadeLocal += fadeStep;
+                fadeLocal = (fadeLocal < 0.) ? 0. : ((fadeLocal > 1.) ? 1. : fadeLocal);
+                diffused += (processDelay<wholeSample>(apf2Local, diffused) - diffused) * fadeLocal;
+                diffused = processDelay<wholeSample>(apf3Local, diffused);
+                diffused += (processDelay<wholeSample>(apf4Local, diffused) - diffused) * fadeLocal;
+            }
+            feed[i] = diffusion == INPUT_DIFFUSION_ON ?
+                diffused : delayed * (1. - diffuse) + diffused * diffuse;
+        }
+        tank.process(feed, feed, leftOutput + start, rightOutput + start, n);
+        tankFeed = feed[n - 1];
+    }
+
+    leftInputDCBlock = leftDCBlockLocal;
+    rightInputDCBlock = rightDCBlockLocal;
+    inputLpf = lpfLocal;
+    inputHpf = hpfLocal;
+    preDelay = preDelayLocal;
+    inApf1 = apf1Local;
+    inApf2 = apf2Local;
+    inApf3 = apf3Local;
+    inApf4 = apf4Local;
+    diffuserFade = fadeLocal;
+
+    applyOutputLevel(leftOutput, rightOutput, size);
+
+    leftOut = leftOutput[size - 1];
+    rightOut = rightOutput[size - 1];
+}
+
+void Dattorro::applyOutputLevel(float* leftOutput, float* rightOutput, size_t size) {
+    if (outputStep == 0. && outputLevel == 1.) {
+        return;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        stepOutputLevel();
+        leftOutput[i] *= outputLevel;
+        rightOutput[i] *= outputLevel;
+    }
 }
 
 void Dattorro::clear() {
@@ -361,10 +785,55 @@ void Dattorro::clear() {
     inApf2.clear();
     inApf3.clear();
     inApf4.clear();
+    resetDiffusers();
 
     tank.clear();
 }
 
+void Dattorro::startClear() {
+    clearIndex = 0;
+    clearOffset = 0;
+}
+
+bool Dattorro::clearSome(int length) {
+    while (length > 0 && clearIndex < kNumClearableDelays) {
+        InterpDelay* delay = clearableDelay(clearIndex);
+        const int end = delay->clearFrom(clearOffset, length);
+        length -= end - clearOffset;
+        clearOffset = end;
+        if (clearOffset == delay->size()) {
+            ++clearIndex;
+            clearOffset = 0;
+        }
+    }
+    if (clearIndex == kNumClearableDelays) {
+        leftInputDCBlock.clear();
+        rightInputDCBlock.clear();
+        inputLpf.clear();
+        inputHpf.clear();
+        inApf1.input = inApf1.output = 0.;
+        inApf2.input = inApf2.output = 0.;
+        inApf3.input = inApf3.output = 0.;
+        inApf4.input = inApf4.output = 0.;
+        resetDiffusers();
+        tank.clearFilters();
+        ++clearIndex;
+    }
+    return clearIndex > kNumClearableDelays;
+}
+
+InterpDelay* Dattorro::clearableDelay(int index) {
+    InterpDelay* delays[kNumClearableDelays] = {
+        &preDelay,
+        &inApf1.delay, &inApf2.delay, &inApf3.delay, &inApf4.delay,
+        &tank.leftApf1.delay, &tank.leftDelay1,
+        &tank.leftApf2.delay, &tank.leftDelay2,
+        &tank.rightApf1.delay, &tank.rightDelay1,
+        &tank.rightApf2.delay, &tank.rightDelay2
+    };
+    return delays[index];
+}
+
 #pragma GCC push_options
 #pragma GCC optimize ("Ofast")
 
@@ -383,7 +852,8 @@ void Dattorro::setTimeScale(float timeScale) {
 #pragma GCC optimize ("Ofast")
 
 void Dattorro::setPreDelay(float t) {
-    preDelay.setDelayTime(t * sampleRate);
+    preDelayTime = t;
+    preDelay.setDelayTime(inputDelayTime(t * sampleRate));
 }
 
 // void Dattorro::setPreDelay(float t) {
@@ -397,10 +867,7 @@ void Dattorro::setSampleRate(float newSampleRate) {
     tank.setSampleRate(sampleRate);
     dattorroScaleFactor = sampleRate / dattorroSampleRate;
     setPreDelay(preDelayTime);
-    inApf1.delay.setDelayTime(dattorroScale(kInApf1Time));
-    inApf2.delay.setDelayTime(dattorroScale(kInApf2Time));
-    inApf3.delay.setDelayTime(dattorroScale(kInApf3Time));
-    inApf4.delay.setDelayTime(dattorroScale(kInApf4Time));
+    setInputApfTimes();
 
     leftInputDCBlock.setSampleRate(sampleRate);
     rightInputDCBlock.setSampleRate(sampleRate);
@@ -444,9 +911,22 @@ void Dattorro::setInputFilterHighCutoffPitch(float pitch) {
 #pragma GCC pop_options
 
 void Dattorro::enableInputDiffusion(bool enable) {
+    // The block process() doesn't run the input allpasses while they're off,
+    // so start them from silence rather than from whatever they had then.
+    if (enable && diffuseInput == 0.) {
+        inApf1.clear();
+        inApf2.clear();
+        inApf3.clear();
+        inApf4.clear();
+        resetDiffusers();
+    }
     diffuseInput = enable ? 1. : 0.;
 }
 
+void Dattorro::setWholeSampleDelays(bool enable) {
+    tank.setWholeSampleDelays(enable);
+}
+
 void Dattorro::setDecay(float newDecay) {
     decay = newDecay;
     tank.setDecay(decay);
@@ -499,6 +979,94 @@ void Dattorro::setTankModShape(const float modShape) {
     tank.setModShape(modShape);
 }
 
+void Dattorro::setTankModPeriod(int samples) {
+    tank.setModPeriod(samples);
+}
+
+void Dattorro::setQuality(ReverbQuality newQuality) {
+    if (newQuality == quality) {
+        return;
+    }
+    if (newQuality == QUALITY_LOW) {
+        // Fade inApf2 and inApf4 out, or keep them out if they were still
+        // being cleared.
+        diffuserClearOffset = -1;
+        diffuserFadeDir = -1.;
+    } else if (quality == QUALITY_LOW) {
+        if (diffuserFade == 0.) {
+            // They haven't run since they went out, so they still hold what
+            // they had then. Clear them before they fade back in.
+            diffuserClearOffset = 0;
+        } else {
+            diffuserFadeDir = 1.;
+        }
+    }
+    quality = newQuality;
+    tank.setQuality(quality);
+    setPreDelay(preDelayTime);
+    setInputApfTimes();
+}
+
+ReverbQuality Dattorro::getQuality() const {
+    return quality;
+}
+
+Dattorro::Diffusers Dattorro::prepareDiffusers(size_t size) {
+    if (diffuserClearOffset >= 0) {
+        int length = static_cast<int>(size) * kDiffuserClearRate;
+        const int apf2Size = inApf2.delay.size();
+        if (diffuserClearOffset < apf2Size) {
+            const int end = inApf2.delay.clearFrom(diffuserClearOffset, length);
+            length -= end - diffuserClearOffset;
+            diffuserClearOffset = end;
+        }
+        if (diffuserClearOffset >= apf2Size && length > 0) {
+            diffuserClearOffset = apf2Size +
+                inApf4.delay.clearFrom(diffuserClearOffset - apf2Size, length);
+        }
+        if (diffuserClearOffset < apf2Size + inApf4.delay.size()) {
+            return DIFFUSERS_OUT;
+        }
+        inApf2.input = inApf2.output = 0.;
+        inApf4.input = inApf4.output = 0.;
+        diffuserClearOffset = -1;
+        diffuserFadeDir = 1.;
+    }
+    if (diffuserFade == 1. && diffuserFadeDir > 0.) {
+        return DIFFUSERS_IN;
+    }
+    if (diffuserFade == 0. && diffuserFadeDir < 0.) {
+        return DIFFUSERS_OUT;
+    }
+    return DIFFUSERS_FADING;
+}
+
+void Dattorro::resetDiffusers() {
+    diffuserClearOffset = -1;
+    diffuserFadeDir = quality == QUALITY_LOW ? -1. : 1.;
+    diffuserFade = quality == QUALITY_LOW ? 0. : 1.;
+}
+
+void Dattorro::rampOutputTo(float level, float seconds) {
+    const float samples = seconds * sampleRate;
+    if (samples < 1.) {
+        setOutputLevel(level);
+        return;
+    }
+    outputTarget = level;
+    outputStep = (level - outputLevel) / samples;
+}
+
+void Dattorro::setOutputLevel(float level) {
+    outputLevel = level;
+    outputTarget = level;
+    outputStep = 0.;
+}
+
+float Dattorro::getOutputLevel() const {
+    return outputLevel;
+}
+
 float Dattorro::getLeftOutput() const {
     return leftOut;
 }
@@ -510,3 +1078,14 @@ float Dattorro::getRightOutput() const {
 float Dattorro::dattorroScale(float delayTime) {
     return delayTime * dattorroScaleFactor;
 }
+
+float Dattorro::inputDelayTime(float samples) const {
+    return quality == QUALITY_HIGH ? samples : std::round(samples);
+}
+
+void Dattorro::setInputApfTimes() {
+    inApf1.delay.setDelayTime(inputDelayTime(dattorroScale(kInApf1Time)));
+    inApf2.delay.setDelayTime(inputDelayTime(dattorroScale(kInApf2Time)));
+    inApf3.delay.setDelayTime(inputDelayTime(dattorroScale(kInApf3Time)));
+    inApf4.delay.setDelayTime(inputDelayTime(dattorroScale(kInApf4Time)));
+}
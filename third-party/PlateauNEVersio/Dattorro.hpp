@@ -4,30 +4,61 @@
 
 #pragma once
 #include "dsp/delays/AllpassFilter.hpp"
+#include "dsp/delays/TapGather.hpp"
 #include "dsp/filters/OnePoleFilters.hpp"
-#include "dsp/modulation/LFO.hpp"
+#include "dsp/modulation/LFOBank.hpp"
 #include <array>
+#include <cstddef>
+
+// How much CPU a plate spends on sounding its best (see Dattorro::setQuality()).
+enum ReverbQuality {
+    QUALITY_LOW,
+    QUALITY_MEDIUM,
+    QUALITY_HIGH
+};
 
 class Dattorro1997Tank {
 public:
+    // The delays' memory comes from `arena`. Only the default one is placed
+    // by delayPlacement; another one lets plates be built on several threads
+    // at once (each with its own arena).
     Dattorro1997Tank(const float initMaxSampleRate = 32000.0,
                      const float initMaxLfoDepth = 0.0,
-                     const float initMaxTimeScale = 1.0);
+                     const float initMaxTimeScale = 1.0,
+                     DelayArena& arena = delayArena);
 
     void process(const float leftInput, const float rightIn,
                  float* leftOut, float* rightOut);
 
+    // Processes a block of samples. The result is the same as calling the
+    // per-sample process() for each one, but the state stays in registers
+    // for the whole block.
+    void process(const float* leftIn, const float* rightIn,
+                 float* leftOut, float* rightOut, size_t size);
+
     void freeze(const bool freezeFlag);
 
     void setSampleRate(const float newSampleRate);
     void setTimeScale(const float newTimeScale);
 
+    // Rounds the tank's delay times to whole samples, which lets process()
+    // skip the interpolation while there's no modulation. The times move by
+    // half a sample at most.
+    void setWholeSampleDelays(const bool enable);
+
     void setDecay(const float newDecay);
 
     void setModSpeed(const float newModSpeed);
     void setModDepth(const float newModDepth);
     void setModShape(const float shape);
 
+    // How often, in samples, the allpass modulation is worked out. The
+    // allpass times are ramped in between (see TriSawLFOBank).
+    void setModPeriod(int samples);
+
+    // See Dattorro::setQuality(). This sets the mod period as well.
+    void setQuality(ReverbQuality newQuality);
+
     void setHighCutFrequency(const float frequency);
     void setLowCutFrequency(const float frequency);
 
@@ -35,6 +66,9 @@ public:
 
     void clear();
 
+    // Everything clear() does apart from zeroing the delays.
+    void clearFilters();
+
     int calcMaxTime(float delayTime);
 
 // private:
@@ -94,6 +128,8 @@ public:
 
     float timePadding = 0.0;
 
+    DelayArena* arena = &delayArena;
+
     float scaledLeftApf1Time = leftApf1Time;
     float scaledLeftDelay1Time = leftDelay1Time;
     float scaledLeftApf2Time = leftApf2Time;
@@ -105,6 +141,7 @@ public:
     float scaledRightDelay2Time = rightDelay2Time;
 
     std::array<int, 7> scaledOutputTaps;
+    int maxScaledOutputTap = 0;
 
     float maxSampleRate = 32000.0;
     float sampleRate = maxSampleRate;
@@ -119,6 +156,9 @@ public:
 
     float lfoExcursion = 0.0;
 
+    bool wholeSampleDelays = false;
+    ReverbQuality quality = QUALITY_HIGH;
+
     // Freeze Cross fade
     bool frozen = false;
     float fade = 1.0;
@@ -126,10 +166,17 @@ public:
     float fadeStep = 1.0 / (fadeTime * sampleRate);
     float fadeDir = 1.0;
 
-    TriSawLFO lfo1;
-    TriSawLFO lfo2;
-    TriSawLFO lfo3;
-    TriSawLFO lfo4;
+    // One LFO per modulated allpass, in the order of ApfLFO.
+    enum ApfLFO {
+        LEFT_APF_1_LFO,
+        LEFT_APF_2_LFO,
+        RIGHT_APF_1_LFO,
+        RIGHT_APF_2_LFO,
+        NUM_APF_LFOS
+    };
+    TriSawLFOBank<NUM_APF_LFOS> lfos;
+    // How far each allpass time moves per sample in this period.
+    float apfTimeSlopes[NUM_APF_LFOS] = {};
 
     float leftSum = 0.0;
     float rightSum = 0.0;
@@ -151,6 +198,17 @@ public:
     OnePoleHPFilter leftOutDCBlock;
     OnePoleHPFilter rightOutDCBlock;
 
+    // The longest stretch of a block whose output taps are gathered in one
+    // go. Any longer and the gather buffers get big for the stack.
+    static constexpr int kTapChunk = 48;
+
+    // The block loop behind process(), with what the settings don't need
+    // compiled out: the allpass modulation, the interpolation and the freeze
+    // fade.
+    template <bool modulated, bool wholeSample, bool fading>
+    void processBlock(const float* leftIn, const float* rightIn,
+                      float* leftOut, float* rightOut, size_t size);
+
     void initialiseDelaysAndApfs();
 
     void tickApfModulation();
@@ -161,13 +219,32 @@ public:
 
 class Dattorro {
 public:
+    // See Dattorro1997Tank for `arena`.
     Dattorro(const float initMaxSampleRate = 32000.0,
              const float initMaxLfoDepth = 16.0,
-             const float initMaxTimeScale = 1.0);
+             const float initMaxTimeScale = 1.0,
+             DelayArena& arena = delayArena);
     void process(float leftInput, float rightInput);
+
+    // Processes a block of planar samples. Same result as calling
+    // process(leftInput, rightInput) and the getters for each sample, except
+    // that after leaving QUALITY_LOW inApf2 and inApf4 start fading back in
+    // at the start of a block rather than on the sample they're clear. The
+    // outputs can be the same buffers as the inputs.
+    void process(const float* leftIn, const float* rightIn,
+                 float* leftOutput, float* rightOutput, size_t size);
+
     void clear();
 
+    // clear() a piece at a time, so that the plate can be cleared from the
+    // audio callback while it isn't running: call startClear(), then
+    // clearSome() until it returns true. Each call zeroes at most `length`
+    // samples of delay memory. See DattorroBypass.
+    void startClear();
+    bool clearSome(int length);
+
     void setTimeScale(float timeScale);
+    void setWholeSampleDelays(bool enable);
     void setPreDelay(float time);
     void setSampleRate(float sampleRate);
 
@@ -185,6 +262,35 @@ public:
     void setTankModSpeed(const float modSpeed);
     void setTankModDepth(const float modDepth);
     void setTankModShape(const float modShape);
+    void setTankModPeriod(int samples);
+
+    // Trades some of the plate's sound for CPU:
+    //
+    //   QUALITY_HIGH    The delays are interpolated (unless they're rounded
+    //                   with setWholeSampleDelays()) and the tank modulation
+    //                   is worked out every 32 samples.
+    //   QUALITY_MEDIUM  The delays whose times don't move are rounded to whole
+    //                   samples and read without interpolating, and the
+    //                   modulation is worked out every 128 samples.
+    //   QUALITY_LOW     The modulated allpasses read whole samples too, the
+    //                   modulation is worked out every 256 samples and only
+    //                   two of the four input allpasses run.
+    //
+    // The rate the plate runs at is the other big lever. That one is picked
+    // when the plate is set up, since it reallocates the delays (see
+    // ReducedRateDattorro). The tier can be changed while the plate runs;
+    // the delay times move by half a sample at most, and the two input
+    // allpasses that the low tier leaves out fade in and out rather than
+    // switching.
+    void setQuality(ReverbQuality newQuality);
+    ReverbQuality getQuality() const;
+
+    // Scales the plate's output, e.g. to bring it back in without a click
+    // after it has been bypassed. rampOutputTo() moves the level in a straight
+    // line over `seconds`; setOutputLevel() jumps straight there.
+    void rampOutputTo(float level, float seconds);
+    void setOutputLevel(float level);
+    float getOutputLevel() const;
 
     float getLeftOutput() const;
     float getRightOutput() const;
@@ -196,6 +302,9 @@ public:
     static constexpr int kInApf3Time = 379;
     static constexpr int kInApf4Time = 277;
 
+    // The block process() feeds the tank this many samples at a time.
+    static constexpr size_t kTankChunk = 32;
+
     static constexpr float dattorroSampleRate = 29761.0;
     float sampleRate = 32000.0;
     float dattorroScaleFactor = sampleRate / dattorroSampleRate;
@@ -231,5 +340,89 @@ public:
 
     float tankFeed = 0.0;
 
+    ReverbQuality quality = QUALITY_HIGH;
+
+    // inApf2 and inApf4, which QUALITY_LOW leaves out, fade in and out of the
+    // input diffusion over diffuserFadeTime rather than switching, with each
+    // one partly bypassed on the way. They don't run while they're out, so
+    // on the way back in they're first cleared a piece at a time, at most
+    // kDiffuserClearRate samples of delay memory for every sample processed,
+    // which keeps the audio callback that changes the tier short.
+    static constexpr int kDiffuserClearRate = 4;
+    float diffuserFade = 1.0;
+    float diffuserFadeTime = 0.01;
+    float diffuserFadeDir = 1.0;
+    // How far through inApf2's delay and then inApf4's the clearing has got,
+    // or -1 while they aren't being cleared.
+    int diffuserClearOffset = -1;
+
+    enum Diffusers {
+        DIFFUSERS_OUT,
+        DIFFUSERS_IN,
+        DIFFUSERS_FADING
+    };
+
+    // Clears some more of inApf2 and inApf4 if they're on their way back in,
+    // and says how the next `size` samples run them.
+    Diffusers prepareDiffusers(size_t size);
+    // Where the diffusers should be for the tier, once all four allpasses
+    // have been cleared.
+    void resetDiffusers();
+
+    inline float stepDiffuserFade() {
+        diffuserFade += diffuserFadeDir / (diffuserFadeTime * sampleRate);
+        diffuserFade = (diffuserFade < 0.) ? 0. : ((diffuserFade > 1.) ? 1. : diffuserFade);
+        return diffuserFade;
+    }
+
+    float outputLevel = 1.0;
+    float outputTarget = 1.0;
+    float outputStep = 0.0;
+
+    // One sample of the output ramp.
+    inline void stepOutputLevel() {
+        outputLevel += outputStep;
+        if ((outputStep > 0. && outputLevel >= outputTarget) ||
+            (outputStep < 0. && outputLevel <= outputTarget)) {
+            outputLevel = outputTarget;
+            outputStep = 0.;
+        }
+    }
+
+    void applyOutputLevel(float* leftOutput, float* rightOutput, size_t size);
+
+    // The pre-delay, the input allpasses and the tank's allpasses and delays,
+    // in the order clearSome() goes through them.
+    static constexpr int kNumClearableDelays = 13;
+    InterpDelay* clearableDelay(int index);
+
+    // Where clearSome() has got to: a delay, then a sample in it. Past the
+    // last delay the filters are cleared, and then it's done.
+    int clearIndex = kNumClearableDelays + 1;
+    int clearOffset = 0;
+
+    // diffuseInput is 0 or 1 unless it's set directly.
+    enum InputDiffusion {
+        INPUT_DIFFUSION_OFF,
+        INPUT_DIFFUSION_ON,
+        INPUT_DIFFUSION_MIXED
+    };
+
+    // The block loop behind process(). With the diffusion off the input
+    // allpasses don't run at all.
+    template <InputDiffusion diffusion, ReverbQuality tier>
+    void processBlock(const float* leftIn, const float* rightIn,
+                      float* leftOutput, float* rightOutput, size_t size);
+
+    // Picks the processBlock() for the input diffusion.
+    template <ReverbQuality tier>
+    void processAtQuality(const float* leftIn, const float* rightIn,
+                          float* leftOutput, float* rightOutput, size_t size);
+
     float dattorroScale(float delayTime);
+
+    // A time, in samples, for a delay on the input side, rounded to whole
+    // samples below QUALITY_HIGH.
+    float inputDelayTime(float samples) const;
+    void setInputApfTimes();
 };
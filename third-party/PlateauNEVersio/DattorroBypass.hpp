@@ -0,0 +1,106 @@
+//
+// Turns a Dattorro on and off from the audio callback without clicks.
+//
+
+#pragma once
+#include "Dattorro.hpp"
+#include "ReducedRateDattorro.hpp"
+#include <cstddef>
+
+// Fades the plate in when it's turned on. With setKillTail(), it also fades
+// the plate out when it's turned off and then clears it, so that it comes
+// back without the old tail.
+//
+// Dattorro::clear() zeroes every delay in one go. That's a few hundred KB,
+// mostly in SDRAM, and far more than one callback has time for, which is why
+// a bypassed plate used to stop where it was and pick the same tail up again
+// when it came back. Here each callback clears a piece in proportion to its
+// length, kClearPerSample floats (four cache lines) per sample. While it
+// clears the plate stays off, even if it's turned back on, and isClearing()
+// says so.
+//
+// A plate that runs behind a ReducedRateDattorro also has the resamplers'
+// history to forget. Pass the wrapper in as well and it's cleared with the
+// plate.
+class DattorroBypass {
+public:
+    static constexpr int kClearPerSample = 32;
+    static constexpr float kFadeInSeconds = 0.01;
+    static constexpr float kFadeOutSeconds = 0.01;
+
+    explicit DattorroBypass(Dattorro& verb, ReducedRateDattorro* resampled = nullptr)
+        : verb(verb), resampled(resampled) {}
+
+    // Without this the plate stops dead when it's turned off and resumes
+    // where it was when it's turned back on.
+    void setKillTail(bool kill) {
+        killTail = kill;
+    }
+
+    // Call once per callback of `size` samples with whether the plate should
+    // be heard. Only run the plate if this returns true.
+    bool update(bool on, size_t size) {
+        switch (state) {
+        case ON:
+            if (on) {
+                return true;
+            }
+            if (killTail) {
+                verb.rampOutputTo(0., kFadeOutSeconds);
+                state = FADING_OUT;
+                return true;
+            }
+            state = OFF;
+            return false;
+
+        case FADING_OUT:
+            if (on) {
+                verb.rampOutputTo(1., kFadeInSeconds);
+                state = ON;
+                return true;
+            }
+            if (verb.getOutputLevel() > 0.) {
+                return true;
+            }
+            verb.startClear();
+            if (resampled != nullptr) {
+                resampled->clearResamplers();
+            }
+            state = CLEARING;
+            // Fall through - the first piece is cleared right away.
+
+        case CLEARING:
+            if (verb.clearSome(static_cast<int>(size) * kClearPerSample)) {
+                state = OFF;
+            }
+            return false;
+
+        case OFF:
+            if (!on) {
+                return false;
+            }
+            verb.setOutputLevel(0.);
+            verb.rampOutputTo(1., kFadeInSeconds);
+            state = ON;
+            return true;
+        }
+        return false;
+    }
+
+    bool isClearing() const {
+        return state == CLEARING;
+    }
+
+private:
+    enum State {
+        OFF,
+        ON,
+        FADING_OUT,
+        CLEARING
+    };
+
+    Dattorro& verb;
+    ReducedRateDattorro* resampled;
+    bool killTail = false;
+    State state = OFF;
+};
@@ -0,0 +1,125 @@
+//
+// A parameter layer in front of Dattorro for knobs that are read every
+// callback.
+//
+
+#pragma once
+#include "Dattorro.hpp"
+#include <cmath>
+#include <cstdint>
+
+// Collects the reverb's parameters and only passes on the ones that have
+// moved.
+//
+// The setters aren't free: the cutoff pitches go through std::pow and then
+// expf for every filter they touch, and the pre-delay moves its read head.
+// Calling them all from every callback costs that every time, and a noisy
+// knob makes the filters recompute even when nobody touches it. Instead,
+// set() everything as often as you like and call apply() once per block
+// before processing. A value only counts as changed when it has moved more
+// than its tolerance from the one last passed on, so knob noise is ignored
+// but a slow turn still gets through once it adds up.
+class DattorroParameters {
+public:
+    enum Parameter {
+        DECAY,
+        TANK_DIFFUSION,
+        INPUT_LOW_CUT_PITCH,
+        INPUT_HIGH_CUT_PITCH,
+        TANK_LOW_CUT_PITCH,
+        TANK_HIGH_CUT_PITCH,
+        TANK_MOD_SPEED,
+        TANK_MOD_DEPTH,
+        TANK_MOD_SHAPE,
+        PRE_DELAY,
+        NUM_PARAMETERS
+    };
+
+    // A fiftieth of an octave for the cutoffs, half a millisecond for the
+    // pre-delay and a thousandth of the range for everything else. That's
+    // about what the pots on the Hothouse wander by when left alone.
+    static constexpr float kPitchTolerance = 0.02;
+    static constexpr float kPreDelayTolerance = 0.0005;
+    static constexpr float kDefaultTolerance = 0.001;
+
+    explicit DattorroParameters(Dattorro& verb) : verb(verb) {
+        for (int p = 0; p < NUM_PARAMETERS; ++p) {
+            tolerances[p] = kDefaultTolerance;
+        }
+        tolerances[INPUT_LOW_CUT_PITCH] = kPitchTolerance;
+        tolerances[INPUT_HIGH_CUT_PITCH] = kPitchTolerance;
+        tolerances[TANK_LOW_CUT_PITCH] = kPitchTolerance;
+        tolerances[TANK_HIGH_CUT_PITCH] = kPitchTolerance;
+        tolerances[PRE_DELAY] = kPreDelayTolerance;
+    }
+
+    // Marks the parameter dirty if it has moved more than its tolerance, or
+    // if it has never been set.
+    void set(Parameter p, float value) {
+        const uint32_t bit = 1u << p;
+        if ((known & bit) && std::fabs(value - values[p]) <= tolerances[p]) {
+            return;
+        }
+        values[p] = value;
+        known |= bit;
+        dirty |= bit;
+    }
+
+    void setTolerance(Parameter p, float tolerance) {
+        tolerances[p] = tolerance;
+    }
+
+    // The value the reverb has (or will have after the next apply()).
+    float get(Parameter p) const {
+        return values[p];
+    }
+
+    bool isDirty() const {
+        return dirty != 0;
+    }
+
+    // Passes the dirty parameters on to the reverb, each one once.
+    void apply() {
+        if (dirty == 0) {
+            return;
+        }
+        if (dirty & (1u << DECAY)) {
+            verb.setDecay(values[DECAY]);
+        }
+        if (dirty & (1u << TANK_DIFFUSION)) {
+            verb.setTankDiffusion(values[TANK_DIFFUSION]);
+        }
+        if (dirty & (1u << INPUT_LOW_CUT_PITCH)) {
+            verb.setInputFilterLowCutoffPitch(values[INPUT_LOW_CUT_PITCH]);
+        }
+        if (dirty & (1u << INPUT_HIGH_CUT_PITCH)) {
+            verb.setInputFilterHighCutoffPitch(values[INPUT_HIGH_CUT_PITCH]);
+        }
+        if (dirty & (1u << TANK_LOW_CUT_PITCH)) {
+            verb.setTankFilterLowCutFrequency(values[TANK_LOW_CUT_PITCH]);
+        }
+        if (dirty & (1u << TANK_HIGH_CUT_PITCH)) {
+            verb.setTankFilterHighCutFrequency(values[TANK_HIGH_CUT_PITCH]);
+        }
+        if (dirty & (1u << TANK_MOD_SPEED)) {
+            verb.setTankModSpeed(values[TANK_MOD_SPEED]);
+        }
+        if (dirty & (1u << TANK_MOD_DEPTH)) {
+            verb.setTankModDepth(values[TANK_MOD_DEPTH]);
+        }
+        if (dirty & (1u << TANK_MOD_SHAPE)) {
+            verb.setTankModShape(values[TANK_MOD_SHAPE]);
+        }
+        if (dirty & (1u << PRE_DELAY)) {
+            verb.setPreDelay(values[PRE_DELAY]);
+        }
+        dirty = 0;
+    }
+
+private:
+    Dattorro& verb;
+    float values[NUM_PARAMETERS] = {};
+    float tolerances[NUM_PARAMETERS];
+    uint32_t known = 0;
+    uint32_t dirty = 0;
+};
@@ -0,0 +1,133 @@
+//
+// Runs a Dattorro plate at a lower sample rate than the audio around it.
+//
+
+#pragma once
+#include "Dattorro.hpp"
+#include "dsp/filters/PolyphaseResampler.hpp"
+#include <cstddef>
+
+// Puts a Dattorro (input diffusion and tank) behind a polyphase decimator and
+// a pair of interpolators, so the wet path can run at 32 or 24 kHz while the
+// pedal, and the dry signal, stay at 48 kHz.
+//
+// The plate's delays are defined at 29761 Hz and the tank's high cut is well
+// below 12 kHz in most settings, so little is lost, and the plate's cost per
+// second drops with its rate: its delays and allpasses run two-thirds or half
+// as often, and its delay memory shrinks by the same amount when the Dattorro
+// is built with the lower rate as its maximum.
+//
+// The plate only ever gets the mono sum of its inputs, so only that is
+// decimated. The interpolators give exactly as many samples as come in, which
+// can take one more plate sample than the block made; that one waits for the
+// next block.
+class ReducedRateDattorro {
+public:
+    // Host samples handled per pass, which sizes the scratch buffers.
+    static constexpr size_t kChunk = 32;
+
+    explicit ReducedRateDattorro(Dattorro& verb) : verb(verb) {}
+
+    // Sets the plate to run at `plateRate` for audio at `hostRate`. The two
+    // have to be equal or in the ratio 2:3 or 1:2; anything else runs the
+    // plate at the host rate.
+    void setSampleRates(float hostRate, float plateRate) {
+        int up = (int)(plateRate + 0.5);
+        int down = (int)(hostRate + 0.5);
+        const int divisor = gcd(up, down);
+        up /= divisor;
+        down /= divisor;
+        reduced = up < down && down <= PolyphaseResampler::kMaxFactor;
+        if (!reduced) {
+            plateRate = hostRate;
+            up = down = 1;
+        }
+        verb.setSampleRate(plateRate);
+        decimator.init(up, down);
+        leftInterpolator.init(down, up);
+        rightInterpolator.init(down, up);
+        pending = 0;
+    }
+
+    bool isReduced() const {
+        return reduced;
+    }
+
+    // Same interface as Dattorro::process(). The outputs can be the same
+    // buffers as the inputs.
+    void process(const float* leftIn, const float* rightIn,
+                 float* leftOut, float* rightOut, size_t size) {
+        if (!reduced) {
+            verb.process(leftIn, rightIn, leftOut, rightOut, size);
+            return;
+        }
+        for (size_t start = 0; start < size; start += kChunk) {
+            const size_t n = size - start < kChunk ? size - start : kChunk;
+
+            // Dattorro sums its inputs, so feeding it half the sum on both
+            // sides is the same as feeding it the pair.
+            float mono[kChunk];
+            for (size_t i = 0; i < n; ++i) {
+                mono[i] = (leftIn[start + i] + rightIn[start + i]) * 0.5f;
+            }
+            float plateIn[kChunk];
+            const size_t made = decimator.process(mono, n, plateIn);
+
+            float plateLeft[kChunk + kMaxPending];
+            float plateRight[kChunk + kMaxPending];
+            for (size_t i = 0; i < pending; ++i) {
+                plateLeft[i] = pendingLeft[i];
+                plateRight[i] = pendingRight[i];
+            }
+            verb.process(plateIn, plateIn, plateLeft + pending, plateRight + pending, made);
+            const size_t available = pending + made;
+
+            const size_t taken = leftInterpolator.pull(plateLeft, available, leftOut + start, n);
+            rightInterpolator.pull(plateRight, available, rightOut + start, n);
+
+            pending = available - taken;
+            RESAMPLER_CHECK(pending <= kMaxPending);
+            for (size_t i = 0; i < pending; ++i) {
+                pendingLeft[i] = plateLeft[taken + i];
+                pendingRight[i] = plateRight[taken + i];
+            }
+        }
+    }
+
+    void clear() {
+        verb.clear();
+        clearResamplers();
+    }
+
+    // Forgets what the resamplers hold, which would otherwise bring the old
+    // tail back for a few samples. Call whenever the plate is cleared
+    // without clear(), e.g. a piece at a time by DattorroBypass.
+    void clearResamplers() {
+        decimator.clear();
+        leftInterpolator.clear();
+        rightInterpolator.clear();
+        pending = 0;
+    }
+
+private:
+    // The interpolators never fall more than one plate sample behind.
+    static constexpr size_t kMaxPending = 2;
+
+    static int gcd(int a, int b) {
+        while (b != 0) {
+            const int t = a % b;
+            a = b;
+            b = t;
+        }
+        return a > 0 ? a : 1;
+    }
+
+    Dattorro& verb;
+    bool reduced = false;
+    PolyphaseResampler decimator;
+    PolyphaseResampler leftInterpolator;
+    PolyphaseResampler rightInterpolator;
+    float pendingLeft[kMaxPending] = {};
+    float pendingRight[kMaxPending] = {};
+    size_t pending = 0;
+};
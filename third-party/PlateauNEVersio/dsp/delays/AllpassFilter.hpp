@@ -14,6 +14,18 @@ public:
         this->gain = gain;
     }
 
+    // Same as assigning AllpassFilter(maxDelay, initDelay, gain), but reuses
+    // the delay memory when it's long enough and has the delay placed (see
+    // InterpDelay::reset()).
+    void reset(int maxDelay, int initDelay = 0, float gain = 0.,
+               DelayArena& arena = delayArena) {
+        delay.reset(maxDelay, arena);
+        delay.setDelayTime(initDelay);
+        input = 0.;
+        output = 0.;
+        this->gain = gain;
+    }
+
     // inline void initializeAllPassFilter(const int &maxDelay, const float &initDelay = 0, const float &gain = 0.) {
     //     clear();
     //     // delay = InterpDelay(maxDelay, initDelay);
@@ -25,10 +37,23 @@ public:
     #pragma GCC optimize ("Ofast")
 
     inline float process() {
-        _inSum = input + delay.output * gain;
-        output = delay.output + _inSum * gain * -1.;
-        delay.input = _inSum;
-        delay.process();
+        return process(input);
+    }
+
+    // Same as process(), with the sample passed in rather than through the
+    // input field.
+    inline float process(const float in) {
+        const float inSum = in + delay.output * gain;
+        output = delay.output + inSum * gain * -1.;
+        delay.process(inSum);
+        return output;
+    }
+
+    // Same as process(in) when the delay time is a whole number of samples.
+    inline float processWholeSample(const float in) {
+        const float inSum = in + delay.output * gain;
+        output = delay.output + inSum * gain * -1.;
+        delay.processWholeSample(inSum);
         return output;
     }
 
@@ -37,8 +62,6 @@ public:
     void clear() {
         input = 0.;
         output = 0.;
-        _inSum = 0.;
-        _outSum = 0.;
         delay.clear();
     }
 
@@ -52,6 +75,4 @@ public:
 
 private:
     float gain;
-    float _inSum;
-    float _outSum;
 };
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+
+#if defined(DEBUG)
+#include <cassert>
+#define DELAY_ARENA_CHECK(condition) assert(condition)
+#else
+#define DELAY_ARENA_CHECK(condition)
+#endif
+
+// Hands out delay memory from one fixed block, each delay getting exactly the
+// length it asks for. Memory is never given back: the delays are set up once
+// at boot, and a delay that is set up again reuses what it already has when
+// it's big enough (see InterpDelay::reset()).
+//
+// allocate() doesn't touch the memory, so delays can be built by global
+// constructors before the SDRAM is running. Call clear() once it is, since
+// the SDRAM isn't zeroed at boot.
+class DelayArena {
+public:
+    // Delays that don't fit share this much memory at the start of the arena,
+    // so that a bad configuration sounds wrong instead of crashing. It's
+    // longer than the longest output tap of the tank.
+    static constexpr size_t kOverflowLength = 8192;
+
+    // constexpr so that the arena is ready before any global constructor
+    // that builds a delay runs. Arenas that delays are only moved into (see
+    // DelayPlacement) don't need an overflow region.
+    constexpr DelayArena(float* memory, size_t capacity,
+                         size_t overflowLength = kOverflowLength) :
+        memory(memory), capacity(capacity),
+        overflowLength(capacity < overflowLength ? capacity : overflowLength),
+        used(this->overflowLength) {}
+
+    // Returns `length` floats, or nullptr if there isn't enough left.
+    float* allocate(size_t length) {
+        if (length > capacity - used) {
+            ++failed;
+            DELAY_ARENA_CHECK(!"delay arena is full");
+            return nullptr;
+        }
+        float* block = memory + used;
+        used += length;
+        ++allocations;
+        return block;
+    }
+
+    // Shared memory for the delays that didn't fit.
+    float* overflow() {
+        return memory;
+    }
+
+    size_t overflowSize() const { return overflowLength; }
+
+    // Everything handed out so far, overflow region included, starts here.
+    float* begin() const { return memory; }
+    size_t lengthUsed() const { return used; }
+
+    // Zeroes everything that has been handed out.
+    void clear() {
+        for (size_t i = 0; i < used; ++i) {
+            memory[i] = 0.;
+        }
+    }
+
+    // Forgets every allocation. Only for tools that build one engine after
+    // another; anything still using the memory will share it with the next
+    // delay.
+    void reset() {
+        used = overflowLength;
+        allocations = 0;
+        failed = 0;
+    }
+
+    size_t lengthAvailable() const { return capacity - used; }
+
+    bool contains(const float* block) const {
+        return block >= memory && block < memory + capacity;
+    }
+
+    size_t bytesUsed() const { return used * sizeof(float); }
+    size_t bytesCapacity() const { return capacity * sizeof(float); }
+    size_t delayCount() const { return allocations; }
+    size_t failedCount() const { return failed; }
+
+    // Writes a one-line summary, e.g. for a log or a serial console.
+    int report(char* buffer, size_t size) const {
+        return snprintf(buffer, size,
+                        "delay arena: %u of %u KB used by %u delays, %u didn't fit",
+                        (unsigned)(bytesUsed() / 1024),
+                        (unsigned)(bytesCapacity() / 1024),
+                        (unsigned)allocations, (unsigned)failed);
+    }
+
+private:
+    float* memory;
+    size_t capacity;
+    size_t overflowLength;
+    size_t used = 0;
+    size_t allocations = 0;
+    size_t failed = 0;
+};
+
+// The arena the plate's delays come from, in SDRAM.
+extern DelayArena delayArena;
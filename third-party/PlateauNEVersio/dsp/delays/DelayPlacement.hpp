@@ -0,0 +1,259 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include "DelayArena.hpp"
+
+// Where a delay's memory is, fastest first.
+enum MemoryTier {
+    MEMORY_DTCM,        // Tightly coupled to the core, no wait states
+    MEMORY_AXI_SRAM,    // On-chip, through the cache
+    MEMORY_SDRAM,       // External, through the cache
+    NUM_MEMORY_TIERS
+};
+
+// Moves the busiest delays out of SDRAM into the faster, much smaller on-chip
+// memories.
+//
+// Every delay starts out in the SDRAM arena (see InterpDelay::reset()) and is
+// tracked here. place() then ranks them by accesses per sample for each float
+// of memory, since that's how much traffic a float of fast memory takes off
+// the SDRAM, and moves them down the list into the fastest tier that still
+// has room. In practice that means the short allpasses go first and the long
+// tank delays and the pre-delay stay in SDRAM.
+//
+// The memory a moved delay had in SDRAM isn't given back. That's at most the
+// size of the fast tiers, and it means nothing breaks if place() is never
+// called.
+//
+// Nothing zeroes the SDRAM at boot, so the delays' memory has to be cleared
+// before they run. clearSome() does that a piece at a time, so the firmware
+// can start its audio first and clear in the background, keeping the delays
+// out of the signal until isCleared(). Only the memory the tracked delays use
+// now is cleared, not what they left behind in SDRAM when they moved.
+class DelayPlacement {
+public:
+    static constexpr size_t kMaxDelays = 64;
+
+    // Floats clearSome() zeroes by default: 16 KB, well under a millisecond.
+    static constexpr size_t kClearLength = 4096;
+
+    // Each delay reads and writes its memory this many times per sample in
+    // process().
+    static constexpr unsigned kProcessAccesses = 3;
+
+    // constexpr for the same reason as DelayArena: delays built by global
+    // constructors add themselves.
+    constexpr DelayPlacement(DelayArena* dtcm, DelayArena* axiSram, DelayArena* sdram) :
+        arenas{dtcm, axiSram, sdram} {}
+
+    // Tracks (or updates) the delay whose memory pointer is at `buffer`. The
+    // pointer has to stay where it is, so only delays that live for good are
+    // added, not temporaries. Delays with memory from some other arena are
+    // left alone.
+    void add(float** buffer, size_t length, unsigned accessesPerSample) {
+        if (!manages(*buffer)) {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (delays[i].buffer == buffer) {
+                delays[i].length = length;
+                delays[i].accesses = accessesPerSample;
+                delays[i].tier = tierOf(*buffer);
+                return;
+            }
+        }
+        if (count == kMaxDelays) {
+            ++untracked;
+            return;
+        }
+        delays[count].buffer = buffer;
+        delays[count].length = length;
+        delays[count].accesses = accessesPerSample;
+        delays[count].tier = tierOf(*buffer);
+        ++count;
+    }
+
+    // Moves delays into faster tiers as described above. Their contents move
+    // with them, so this can be called again after more delays are added.
+    void place() {
+        size_t order[kMaxDelays];
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        // Busiest first: a.accesses / a.length > b.accesses / b.length.
+        std::stable_sort(order, order + count, [this](size_t a, size_t b) {
+            return delays[a].accesses * delays[b].length >
+                   delays[b].accesses * delays[a].length;
+        });
+        for (size_t i = 0; i < count; ++i) {
+            Delay& delay = delays[order[i]];
+            for (int tier = MEMORY_DTCM; tier < delay.tier; ++tier) {
+                DelayArena* arena = arenas[tier];
+                if (arena == nullptr || arena->lengthAvailable() < delay.length) {
+                    continue;
+                }
+                float* memory = arena->allocate(delay.length);
+                for (size_t j = 0; j < delay.length; ++j) {
+                    memory[j] = (*delay.buffer)[j];
+                }
+                *delay.buffer = memory;
+                delay.tier = static_cast<MemoryTier>(tier);
+                break;
+            }
+        }
+    }
+
+    // Stops tracking the delays added so far, leaving them where they are.
+    // Only for tools that link more than one effect and place one of them.
+    void forget() {
+        count = 0;
+        untracked = 0;
+    }
+
+    // Zeroes the memory of every tracked delay in one go.
+    void clear() {
+        startClear();
+        while (!clearSome(static_cast<size_t>(-1))) {
+        }
+    }
+
+    // Starts clearing over again, e.g. after place() or after more delays
+    // were added. Until clearSome() catches up, isCleared() is false.
+    void startClear() {
+        cleared.store(false);
+        clearRegion = 0;
+        clearOffset = 0;
+    }
+
+    // Zeroes up to `length` more floats and returns whether everything is
+    // clear now.
+    bool clearSome(size_t length = kClearLength) {
+        float* start;
+        size_t regionLength;
+        while (length > 0 && region(clearRegion, &start, &regionLength)) {
+            const size_t n = std::min(length, regionLength - clearOffset);
+            std::fill(start + clearOffset, start + clearOffset + n, 0.f);
+            clearOffset += n;
+            length -= n;
+            if (clearOffset == regionLength) {
+                ++clearRegion;
+                clearOffset = 0;
+            }
+        }
+        if (!region(clearRegion, &start, &regionLength)) {
+            cleared.store(true);
+        }
+        return cleared.load();
+    }
+
+    // Safe to call from the audio callback while clearSome() runs elsewhere.
+    bool isCleared() const {
+        return cleared.load();
+    }
+
+    bool manages(const float* memory) const {
+        for (const DelayArena* arena : arenas) {
+            if (arena != nullptr && arena->contains(memory)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    MemoryTier tierOf(const float* memory) const {
+        for (int tier = MEMORY_DTCM; tier < NUM_MEMORY_TIERS; ++tier) {
+            if (arenas[tier] != nullptr && arenas[tier]->contains(memory)) {
+                return static_cast<MemoryTier>(tier);
+            }
+        }
+        return MEMORY_SDRAM;
+    }
+
+    size_t delayCount() const { return count; }
+
+    // Bytes of the tracked delays that are in `tier` now.
+    size_t bytesIn(MemoryTier tier) const {
+        size_t length = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (delays[i].tier == tier) {
+                length += delays[i].length;
+            }
+        }
+        return length * sizeof(float);
+    }
+
+    // Writes where everything landed: one line per tier, then one per delay in
+    // the order they were added.
+    int report(char* buffer, size_t size) const {
+        static const char* const names[NUM_MEMORY_TIERS] = {"DTCM", "AXI SRAM", "SDRAM"};
+        size_t written = 0;
+        const auto print = [&](const char* format, auto... args) {
+            const size_t at = std::min(written, size);
+            const int n = snprintf(buffer + at, size - at, format, args...);
+            if (n > 0) {
+                written += static_cast<size_t>(n);
+            }
+        };
+        for (int tier = MEMORY_DTCM; tier < NUM_MEMORY_TIERS; ++tier) {
+            unsigned delaysInTier = 0;
+            for (size_t i = 0; i < count; ++i) {
+                delaysInTier += delays[i].tier == tier;
+            }
+            const DelayArena* arena = arenas[tier];
+            print("%-8s %5u of %5u KB, %u delays\n", names[tier],
+                  (unsigned)(bytesIn(static_cast<MemoryTier>(tier)) / 1024),
+                  (unsigned)(arena != nullptr ? arena->bytesCapacity() / 1024 : 0),
+                  delaysInTier);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            print("  %6u samples, %u accesses/sample: %s\n",
+                  (unsigned)delays[i].length, delays[i].accesses, names[delays[i].tier]);
+        }
+        if (untracked > 0) {
+            print("  %u more delays weren't tracked and stay in SDRAM\n", (unsigned)untracked);
+        }
+        return static_cast<int>(written);
+    }
+
+private:
+    // The memory clearSome() works through: each tracked delay's, then each
+    // arena's overflow region. If some delays aren't tracked it falls back to
+    // everything each arena has handed out.
+    bool region(size_t index, float** start, size_t* length) const {
+        if (untracked == 0 && index < count) {
+            *start = *delays[index].buffer;
+            *length = delays[index].length;
+            return true;
+        }
+        index -= untracked == 0 ? count : 0;
+        if (index >= NUM_MEMORY_TIERS) {
+            return false;
+        }
+        const DelayArena* arena = arenas[index];
+        *start = arena != nullptr ? arena->begin() : nullptr;
+        *length = arena == nullptr ? 0 :
+                  (untracked == 0 ? arena->overflowSize() : arena->lengthUsed());
+        return true;
+    }
+
+    struct Delay {
+        float** buffer = nullptr;
+        size_t length = 0;
+        unsigned accesses = 0;
+        MemoryTier tier = MEMORY_SDRAM;
+    };
+
+    DelayArena* arenas[NUM_MEMORY_TIERS];
+    Delay delays[kMaxDelays] = {};
+    size_t count = 0;
+    size_t untracked = 0;
+
+    std::atomic<bool> cleared{false};
+    size_t clearRegion = 0;
+    size_t clearOffset = 0;
+};
+
+// Places the plate's delays across the DTCM, AXI SRAM and SDRAM arenas.
+extern DelayPlacement delayPlacement;
@@ -1,7 +1,17 @@
-#include "InterpDelay.hpp"
-
-float DSY_SDRAM_BSS sdramData[50][144000];
-unsigned int count = 0;
-bool triggerClear;
-float clearPopCancelValue = 1.;
-float hold = 0.;
\ No newline at end of file
+#include "InterpDelay.hpp"
+
+// Room for three plates with 4x time scale and a 4 s pre-delay.
+static constexpr size_t kDelayArenaLength = 1 << 20;
+static float DSY_SDRAM_BSS delayArenaMemory[kDelayArenaLength];
+DelayArena delayArena(delayArenaMemory, kDelayArenaLength);
+
+// The fast tiers only get what DelayPlacement moves into them. DTCM is shared
+// with the stack, so only a small part of it is used. On the host all three
+// are ordinary memory, which is enough to see where things would land.
+static constexpr size_t kDtcmDelayArenaLength = 4096;
+static constexpr size_t kAxiSramDelayArenaLength = 16384;
+static float DSY_DTCMRAM dtcmDelayArenaMemory[kDtcmDelayArenaLength];
+static float axiSramDelayArenaMemory[kAxiSramDelayArenaLength];
+static DelayArena dtcmDelayArena(dtcmDelayArenaMemory, kDtcmDelayArenaLength, 0);
+static DelayArena axiSramDelayArena(axiSramDelayArenaMemory, kAxiSramDelayArenaLength, 0);
+DelayPlacement delayPlacement(&dtcmDelayArena, &axiSramDelayArena, &delayArena);
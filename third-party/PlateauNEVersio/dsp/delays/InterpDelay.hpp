@@ -2,86 +2,158 @@
 #include <vector>
 #include <cstdint>
 #include "../../utilities/Utilities.hpp"
-
-extern float DSY_SDRAM_BSS sdramData[50][144000];
-extern unsigned int count;
-extern float hold;
-extern bool triggerClear;
-extern float clearPopCancelValue;
+#include "DelayArena.hpp"
+#include "DelayPlacement.hpp"
 
 class InterpDelay {
 public:
     float input = 0.;
     float output = 0.;
-    int bufferNumber = 0;
-    int r = 0;
-    int upperR = 0;
-    int j = 0;
-    float dataR = 0.;
-    float dataUpperR = 0.;
-
-    //InterpDelay () {}
-
-    InterpDelay(unsigned int maxLength = 512, float initDelayTime = 0.) {
-        l = maxLength;
-        lfloat = static_cast<float>(maxLength);
-
-        bufferNumber = ++count;
 
+    // A delay built with no length has no memory until reset() is called.
+    // Delays built with a length aren't tracked by delayPlacement, so that
+    // temporaries can be assigned; reset() the delay in place to have it
+    // placed.
+    InterpDelay(unsigned int maxLength = 0, float initDelayTime = 0.) {
+        resize(maxLength, delayArena);
         setDelayTime(initDelayTime);
     }
 
-    // inline void initializeDelay(const unsigned int &length = 512, const float &delayTime = 0.) {
-    //     l = length;
-    //     lfloat = static_cast<float>(length);
-
-    //     bufferNumber = ++count;
+    // Starts the delay over with a new maximum length, as if it had just
+    // been built. The memory it already has is reused (and zeroed) if it's
+    // long enough, so calling this again doesn't take more of the arena.
+    // New memory comes from `arena`.
+    //
+    // The delay is tracked by delayPlacement from here on (if its memory is
+    // in one of the placement's arenas), so it mustn't move in memory
+    // afterwards.
+    void reset(unsigned int maxLength, DelayArena& arena = delayArena) {
+        resize(maxLength, arena);
+        addToPlacement();
+    }
 
-    //     setDelayTime(delayTime);
-    // }
+    // Reads per sample made through tap(), on top of the ones process()
+    // makes. Busier delays get the faster memory (see DelayPlacement).
+    void setTapsPerSample(unsigned int taps) {
+        tapsPerSample = taps;
+        addToPlacement();
+    }
 
     #pragma GCC push_options
     #pragma GCC optimize ("Ofast")
 
     inline void process() {
-        //if(!triggerClear) {
-            sdramData[bufferNumber][w] = input;
-            r = w - t;
-            
-            if (r < 0) {
-                r += l;
-            }
+        process(input);
+    }
 
-            ++w;
-            if (w >= l) {
-                w = 0;
-            }
+    // Writes a sample and returns the delayed one, without going through the
+    // input field. The block loops use this one.
+    inline float process(const float in) {
+        DELAY_ARENA_CHECK(w >= 0 && w < l);
+        buffer[w] = in;
+        int r = w - t;
 
-            upperR = r - 1;
-            if (upperR < 0) {
-                upperR += l;
-            }
+        if (r < 0) {
+            r += l;
+        }
+
+        ++w;
+        if (w >= l) {
+            w = 0;
+        }
+
+        int upperR = r - 1;
+        if (upperR < 0) {
+            upperR += l;
+        }
 
-            dataR = sdramData[bufferNumber][r];
-            dataUpperR = sdramData[bufferNumber][upperR];
-            
-            dataR *= clearPopCancelValue;
-            dataUpperR *= clearPopCancelValue;
+        DELAY_ARENA_CHECK(r >= 0 && r < l && upperR >= 0);
+        float dataR = buffer[r];
+        float dataUpperR = buffer[upperR];
 
-            output = hold * (dataR + f * (dataUpperR - dataR));
-        //}
+        output = dataR + f * (dataUpperR - dataR);
+        return output;
+    }
+
+    // Same as process(in) when the delay time is a whole number of samples
+    // (see isWholeSample()), without the read it would interpolate with.
+    inline float processWholeSample(const float in) {
+        DELAY_ARENA_CHECK(w >= 0 && w < l);
+        buffer[w] = in;
+        int r = w - t;
+
+        if (r < 0) {
+            r += l;
+        }
+
+        ++w;
+        if (w >= l) {
+            w = 0;
+        }
+
+        DELAY_ARENA_CHECK(r >= 0 && r < l);
+        output = buffer[r];
+        return output;
     }
 
     #pragma GCC pop_options
     #pragma GCC push_options
     #pragma GCC optimize ("Ofast")
 
-    inline float tap(const int &i) {
-        j = w - i;
+    inline float tap(const int &i) const {
+        int j = w - i;
         if (j < 0) {
             j += l;
         }
-        return sdramData[bufferNumber][j];
+        DELAY_ARENA_CHECK(j >= 0 && j < l);
+        return buffer[j];
+    }
+
+    #pragma GCC pop_options
+    #pragma GCC push_options
+    #pragma GCC optimize ("Ofast")
+
+    // Where tap(i) will read right after the next call to process(). Each
+    // call after that moves it one sample on, wrapping at the end of the
+    // delay.
+    inline const float* tapAddress(int i) const {
+        return buffer + nextTapIndex(i);
+    }
+
+    // Copies what tap(i) would return after each of the next `size` calls
+    // to process(), without calling it. That's two straight runs of the
+    // buffer at most, instead of `size` reads each with its own wrap check.
+    // Only valid for i > size: a shorter tap would read samples those calls
+    // write.
+    inline void gatherTap(int i, float* out, int size) const {
+        DELAY_ARENA_CHECK(i > size && size <= l);
+        const int j = nextTapIndex(i);
+        const int first = size < l - j ? size : l - j;
+        const float* from = buffer + j;
+        for (int n = 0; n < first; ++n) {
+            out[n] = from[n];
+        }
+        for (int n = first; n < size; ++n) {
+            out[n] = buffer[n - first];
+        }
+    }
+
+    // Asks the cache for the samples tap(i) will read in the `size` calls to
+    // process() after the next `size`, so they're in by the time they're
+    // gathered.
+    inline void prefetchTap(int i, int size) const {
+        const int start = nextTapIndex(i) + size;
+        int j = start % l;
+        for (int n = 0; n < size; n += kFloatsPerCacheLine) {
+            __builtin_prefetch(buffer + j);
+            j += kFloatsPerCacheLine;
+            if (j >= l) {
+                j -= l;
+            }
+        }
+        // The run seldom starts on a line boundary, so its end can be on
+        // one more line.
+        __builtin_prefetch(buffer + (start + size - 1) % l);
     }
 
     #pragma GCC pop_options
@@ -99,18 +171,104 @@ public:
         f = newDelayTime - static_cast<float>(t);
     }
 
+    // Moves the delay time on by `step` samples, less than one either way,
+    // without the float to int conversion setDelayTime() makes. For ramping
+    // between times that setDelayTime() was given, which keeps it in range.
+    inline void rampDelayTime(float step) {
+        f += step;
+        if (f >= 1.) {
+            f -= 1.;
+            ++t;
+        } else if (f < 0.) {
+            f += 1.;
+            --t;
+        }
+        DELAY_ARENA_CHECK(t >= 0 && t < l);
+    }
+
     #pragma GCC pop_options
 
+    bool isWholeSample() const {
+        return f == 0.;
+    }
+
     void clear() {
-        // uint32_t **tempPtr = (uint32_t**)sdramData;
         for(int i = 0; i < l; ++i) {
-            sdramData[bufferNumber][i] = uint32_t(0);
+            buffer[i] = 0.;
         }
         input = 0.;
         output = 0.;
     }
 
+    // Zeroes up to `length` samples from `start` on and returns where it
+    // stopped, which is size() once it has reached the end. For clearing a
+    // delay a piece at a time (see Dattorro::clearSome()).
+    int clearFrom(int start, int length) {
+        const int end = length < l - start ? start + length : l;
+        for (int i = start; i < end; ++i) {
+            buffer[i] = 0.;
+        }
+        if (end == l) {
+            input = 0.;
+            output = 0.;
+        }
+        return end;
+    }
+
+    int size() const {
+        return l;
+    }
+
 private:
+    // 32-byte lines, as on the Cortex-M7.
+    static constexpr int kFloatsPerCacheLine = 8;
+
+    // The index tap(i) reads once w has moved on by one.
+    inline int nextTapIndex(int i) const {
+        DELAY_ARENA_CHECK(i >= 1 && i <= l);
+        int j = w + 1 - i;
+        if (j >= l) {
+            j -= l;
+        }
+        if (j < 0) {
+            j += l;
+        }
+        return j;
+    }
+
+    void resize(unsigned int maxLength, DelayArena& arena) {
+        if (maxLength > allocated) {
+            buffer = arena.allocate(maxLength);
+            allocated = maxLength;
+            if (buffer == nullptr) {
+                buffer = arena.overflow();
+                allocated = maxLength < DelayArena::kOverflowLength ?
+                            maxLength : DelayArena::kOverflowLength;
+            }
+        } else {
+            for (unsigned int i = 0; i < maxLength; ++i) {
+                buffer[i] = 0.;
+            }
+        }
+        l = maxLength < allocated ? maxLength : allocated;
+        lfloat = static_cast<float>(l);
+        w = 0;
+        t = 0;
+        f = 0.;
+        input = 0.;
+        output = 0.;
+    }
+
+    void addToPlacement() {
+        if (buffer != nullptr) {
+            delayPlacement.add(&buffer, allocated,
+                               DelayPlacement::kProcessAccesses + tapsPerSample);
+        }
+    }
+
+    float* buffer = nullptr;
+    unsigned int allocated = 0;
+    unsigned int tapsPerSample = 0;
     int  w = 0;
     int t = 0;
     float f = 0.;
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include "InterpDelay.hpp"
+
+// Reads a block's worth of delay taps up front, in memory order.
+//
+// A plate's output taps are a dozen or more reads per sample, scattered over
+// delays that mostly live in SDRAM, and each one works out its own index and
+// wrap. Over a block, though, every tap just walks forward through its
+// delay, so the whole block's reads for one tap are a straight run (two if
+// it wraps). gather() copies those runs into small local buffers before the
+// block runs, ordered by address so that taps in the same delay, and delays
+// next to each other, are read one after the other, and asks the cache for
+// the runs the next block will need.
+//
+// The taps have to be longer than the block, since a shorter one would read
+// samples the block writes. Process in blocks of at most maxBlock() to be
+// sure.
+template <int kTaps, int kMaxBlock>
+class TapGather {
+public:
+    // Tap `index` reads tap(delayTime) from `delay`. The delay has to stay
+    // where it is until the last gather() that uses it.
+    void set(int index, const InterpDelay& delay, int delayTime) {
+        taps[index].delay = &delay;
+        taps[index].delayTime = delayTime;
+        taps[index].values = values[index];
+    }
+
+    // The longest block that every tap set so far is safe for.
+    int maxBlock() const {
+        int block = kMaxBlock;
+        for (const Tap& tap : taps) {
+            block = tap.delayTime - 1 < block ? tap.delayTime - 1 : block;
+        }
+        return block;
+    }
+
+    #pragma GCC push_options
+    #pragma GCC optimize ("Ofast")
+
+    // Fills every tap's buffer with the values it reads over the next `size`
+    // calls to its delay's process().
+    void gather(int size) {
+        DELAY_ARENA_CHECK(size <= kMaxBlock);
+        for (Tap& tap : taps) {
+            tap.address = tap.delay->tapAddress(tap.delayTime);
+        }
+
+        // A dozen or so taps, almost in order from the last block.
+        Tap* order[kTaps];
+        for (int t = 0; t < kTaps; ++t) {
+            Tap* tap = &taps[t];
+            int u = t;
+            for (; u > 0 && order[u - 1]->address > tap->address; --u) {
+                order[u] = order[u - 1];
+            }
+            order[u] = tap;
+        }
+
+        for (Tap* tap : order) {
+            tap->delay->gatherTap(tap->delayTime, tap->values, size);
+        }
+        for (Tap* tap : order) {
+            tap->delay->prefetchTap(tap->delayTime, size);
+        }
+    }
+
+    #pragma GCC pop_options
+
+    // What tap `index` reads after each of the calls to process() that the
+    // last gather() covered.
+    const float* operator[](int index) const {
+        return values[index];
+    }
+
+private:
+    struct Tap {
+        const InterpDelay* delay = nullptr;
+        int delayTime = 1;
+        const float* address = nullptr;
+        float* values = nullptr;
+    };
+
+    Tap taps[kTaps];
+    float values[kTaps][kMaxBlock];
+};
@@ -25,7 +25,11 @@ public:
     #pragma GCC optimize ("Ofast")
 
     inline float process() {
-        _z =  _a * input + _z * _b;
+        return process(input);
+    }
+
+    inline float process(const float in) {
+        _z =  _a * in + _z * _b;
         output = _z;
         return output;
     }
@@ -103,7 +107,11 @@ public:
     #pragma GCC optimize ("Ofast")
 
     inline float process() {
-        _x0 = input;
+        return process(input);
+    }
+
+    inline float process(const float in) {
+        _x0 = in;
         _y0 = _a0 * _x0 + _a1 * _x1 + _b1 * _y1;
         _y1 = _y0;
         _x1 = _x0;
@@ -0,0 +1,161 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+#if defined(DEBUG)
+#include <cassert>
+#define RESAMPLER_CHECK(condition) assert(condition)
+#else
+#define RESAMPLER_CHECK(condition)
+#endif
+
+// Changes the sample rate by up/down (e.g. 1/2 for 48 to 24 kHz, 3/2 for 32
+// to 48 kHz) with a windowed-sinc lowpass.
+//
+// Conceptually the input is zero-stuffed up by `up`, lowpassed and then only
+// every `down`th sample kept. The polyphase form skips the zeros and the
+// samples that would be thrown away, so each output costs one short dot
+// product of at most kTaps multiplies.
+class PolyphaseResampler {
+public:
+    static constexpr int kMaxFactor = 3;
+
+    // Filter length in samples of the faster of the two rates. At 48 kHz
+    // that's a transition band of about 4 kHz with 60 dB or so of stopband,
+    // which is plenty for a reverb's wet path.
+    static constexpr int kTaps = 32;
+
+    // Where the response is 6 dB down, as a fraction of the slower rate's
+    // Nyquist. Down and back up again, 24 kHz is flat to about 8 kHz and
+    // 32 kHz to about 11 kHz.
+    static constexpr double kPassband = 0.9;
+
+    void init(int newUp, int newDown) {
+        RESAMPLER_CHECK(newUp >= 1 && newUp <= kMaxFactor);
+        RESAMPLER_CHECK(newDown >= 1 && newDown <= kMaxFactor);
+        up = newUp;
+        down = newDown;
+
+        // Filter at the zero-stuffed rate, up * the input rate.
+        const int length = kTaps * (up < down ? up : down);
+        tapsPerPhase = length / up;
+        const double cutoff = kPassband * 0.5 / (up > down ? up : down);
+        const double middle = (length - 1) * 0.5;
+        const double beta = 6.0;
+        double sum = 0.0;
+        double h[kTaps * kMaxFactor];
+        for (int n = 0; n < length; ++n) {
+            const double x = n - middle;
+            const double sinc = x == 0.0 ? 2.0 * cutoff :
+                std::sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+            const double r = x / (middle + 0.5);
+            h[n] = sinc * besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+            sum += h[n];
+        }
+
+        // Unity gain at DC. The zero-stuffing divides the level by `up`.
+        for (int p = 0; p < up; ++p) {
+            for (int k = 0; k < tapsPerPhase; ++k) {
+                coefficients[p * tapsPerPhase + k] = (float)(h[p + k * up] * up / sum);
+            }
+        }
+        clear();
+    }
+
+    void clear() {
+        for (float& sample : history) {
+            sample = 0.0;
+        }
+        newest = 0;
+        phase = 0;
+        pulling = false;
+    }
+
+    #pragma GCC push_options
+    #pragma GCC optimize ("Ofast")
+
+    // Takes all `inSize` input samples and returns how many outputs it wrote,
+    // which is at most inSize * up / down rounded up. For decimating.
+    size_t process(const float* in, size_t inSize, float* out) {
+        size_t written = 0;
+        for (size_t i = 0; i < inSize; ++i) {
+            push(in[i]);
+            while (phase < up) {
+                out[written++] = dot(phase);
+                phase += down;
+            }
+            phase -= up;
+        }
+        return written;
+    }
+
+    // Writes exactly `outSize` outputs and returns how many of the `inSize`
+    // input samples it took. For interpolating, where the output side sets
+    // the pace. Once the input runs out the last one is held.
+    size_t pull(const float* in, size_t inSize, float* out, size_t outSize) {
+        if (!pulling) {
+            // The first output needs the first input.
+            phase = up;
+            pulling = true;
+        }
+        size_t taken = 0;
+        for (size_t o = 0; o < outSize; ++o) {
+            while (phase >= up) {
+                RESAMPLER_CHECK(taken < inSize);
+                push(taken < inSize ? in[taken++] : history[newest]);
+                phase -= up;
+            }
+            out[o] = dot(phase);
+            phase += down;
+        }
+        return taken;
+    }
+
+    #pragma GCC pop_options
+
+    int upFactor() const { return up; }
+    int downFactor() const { return down; }
+
+private:
+    static double besselI0(double x) {
+        double term = 1.0;
+        double sum = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    #pragma GCC push_options
+    #pragma GCC optimize ("Ofast")
+
+    // The history is kept twice over so that the newest tapsPerPhase samples
+    // are always contiguous, newest first.
+    inline void push(float in) {
+        newest = newest == 0 ? tapsPerPhase - 1 : newest - 1;
+        history[newest] = in;
+        history[newest + tapsPerPhase] = in;
+    }
+
+    inline float dot(int p) const {
+        const float* c = coefficients + p * tapsPerPhase;
+        const float* x = history + newest;
+        float sum = 0.0;
+        for (int k = 0; k < tapsPerPhase; ++k) {
+            sum += c[k] * x[k];
+        }
+        return sum;
+    }
+
+    #pragma GCC pop_options
+
+    int up = 1;
+    int down = 1;
+    int tapsPerPhase = 1;
+    int newest = 0;
+    int phase = 0;
+    bool pulling = false;
+    float coefficients[kTaps * kMaxFactor] = {};
+    float history[2 * kTaps] = {};
+};
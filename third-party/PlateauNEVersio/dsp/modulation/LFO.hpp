@@ -3,6 +3,7 @@
 #include <vector>
 #include <cmath>
 #include <cstdint>
+#include <cstddef>
 
 #ifndef  M_PI
 #define M_PI		3.14159265358979323846
@@ -44,6 +45,27 @@ public:
         return _output;
     }
 
+    // Same as calling process() this many times, for when the output isn't
+    // needed but the phase has to keep moving.
+    inline void skip(size_t samples) {
+        if (samples == 0) {
+            return;
+        }
+        for (size_t i = 1; i < samples; ++i) {
+            if(_step > 1.0) {
+                _step -= 1.0;
+                _rising = true;
+            }
+
+            if(_step >= _revPoint) {
+                _rising = false;
+            }
+
+            _step += _stepSize;
+        }
+        process();
+    }
+
     inline void setFrequency(const float &frequency) {
         if (frequency == _frequency) {
             return;
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+
+// kLFOs TriSawLFOs side by side, for slow modulation that doesn't need to be
+// worked out every sample, such as the tank's allpass times.
+//
+// Each LFO's state is an entry in a handful of arrays, and the LFOs are only
+// evaluated once every getPeriod() samples. In between, the caller ramps
+// whatever they modulate in a straight line, getSlope() per sample, to where
+// it will be at the start of the next period. A triangle or a saw is a
+// straight line anyway, so apart from cutting its corners that's what the
+// LFOs would have given sample by sample, without the branches.
+//
+// Call tick() once per sample (or skip() for many). When it returns true a
+// new period has started, and getValue() is each LFO's output now.
+template <int kLFOs>
+class TriSawLFOBank {
+public:
+    // 32 samples is a millisecond at 32 kHz. The tank's LFOs run at a tenth
+    // of a hertz or so, so that's still thousands of points per cycle.
+    static constexpr int kDefaultPeriod = 32;
+
+    explicit TriSawLFOBank(float sampleRate = 32000.0, int period = kDefaultPeriod) {
+        for (int k = 0; k < kLFOs; ++k) {
+            step[k] = 0.;
+            frequency[k] = 0.;
+            value[k] = 0.;
+            slope[k] = 0.;
+            setRevPoint(k, 0.5);
+        }
+        setSampleRate(sampleRate);
+        setPeriod(period);
+    }
+
+    void setSampleRate(float sampleRate) {
+        sampleTime = 1. / sampleRate;
+        for (int k = 0; k < kLFOs; ++k) {
+            stepSize[k] = frequency[k] * sampleTime;
+        }
+    }
+
+    void setFrequency(int lfo, float newFrequency) {
+        frequency[lfo] = newFrequency;
+        stepSize[lfo] = newFrequency * sampleTime;
+    }
+
+    // Where the LFO turns from rising to falling, as a fraction of its cycle.
+    // 0.5 is a triangle, and the ends are saws.
+    void setRevPoint(int lfo, float newRevPoint) {
+        newRevPoint = newRevPoint < 0.0001 ? 0.0001 : newRevPoint;
+        newRevPoint = newRevPoint > 0.999 ? 0.999 : newRevPoint;
+        revPoint[lfo] = newRevPoint;
+        riseRate[lfo] = 1. / newRevPoint;
+        fallRate[lfo] = -1. / (1. - newRevPoint);
+    }
+
+    // Samples per evaluation. A change takes effect at the next period.
+    void setPeriod(int samples) {
+        period = samples < 1 ? 1 : samples;
+    }
+
+    int getPeriod() const {
+        return period;
+    }
+
+    #pragma GCC push_options
+    #pragma GCC optimize ("Ofast")
+
+    inline bool tick() {
+        if (countdown == 0) {
+            next();
+            countdown = period - 1;
+            return true;
+        }
+        --countdown;
+        return false;
+    }
+
+    // Same as calling tick() this many times.
+    inline void skip(size_t samples) {
+        while (samples > 0) {
+            if (countdown == 0) {
+                next();
+                countdown = period;
+            }
+            const size_t n = samples < (size_t)countdown ? samples : (size_t)countdown;
+            countdown -= (int)n;
+            samples -= n;
+        }
+    }
+
+    #pragma GCC pop_options
+
+    // The LFO's output, from -1 to 1, at the start of the current period.
+    float getValue(int lfo) const {
+        return value[lfo];
+    }
+
+    // How much the output moves per sample until the next period.
+    float getSlope(int lfo) const {
+        return slope[lfo];
+    }
+
+private:
+    // What TriSawLFO::process() gives at phase `phase`.
+    inline float shape(int k, float phase) const {
+        const float out = phase < revPoint[k] ?
+            phase * riseRate[k] : phase * fallRate[k] - fallRate[k];
+        return out * 2. - 1.;
+    }
+
+    #pragma GCC push_options
+    #pragma GCC optimize ("Ofast")
+
+    // Evaluates every LFO now and at the start of the next period, and moves
+    // them on to there.
+    inline void next() {
+        const float samples = (float)period;
+        const float perSample = 1. / samples;
+        for (int k = 0; k < kLFOs; ++k) {
+            float now = step[k];
+            if (now > 1.) {
+                now -= 1.;
+            }
+            float then = now + stepSize[k] * samples;
+            step[k] = then;
+            if (then > 1.) {
+                then -= 1.;
+            }
+            value[k] = shape(k, now);
+            slope[k] = (shape(k, then) - value[k]) * perSample;
+        }
+    }
+
+    #pragma GCC pop_options
+
+    float step[kLFOs];
+    float stepSize[kLFOs];
+    float frequency[kLFOs];
+    float revPoint[kLFOs];
+    float riseRate[kLFOs];
+    float fallRate[kLFOs];
+    float value[kLFOs];
+    float slope[kLFOs];
+
+    float sampleTime = 1. / 32000.;
+    int period = kDefaultPeriod;
+    int countdown = 0;
+};